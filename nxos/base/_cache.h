@@ -0,0 +1,88 @@
+/** @file _cache.h
+ *  @brief Internal MMU and cache definitions.
+ *
+ * This file is also included by the startup code (init.S, mmu.S).
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE__CACHE_H__
+#define __NXOS_BASE__CACHE_H__
+
+/** @addtogroup kernelinternal */
+/*@{*/
+
+/** @defgroup cacheinternal MMU and caches
+ */
+/*@{*/
+
+/** @name SCTLR bits */
+/*@{*/
+#define NX__SCTLR_M (1 << 0) /**< MMU enable. */
+#define NX__SCTLR_C (1 << 2) /**< Data cache enable. */
+#define NX__SCTLR_Z (1 << 11) /**< Branch prediction enable. */
+#define NX__SCTLR_I (1 << 12) /**< Instruction cache enable. */
+/*@}*/
+
+/** @name Translation table descriptors
+ *
+ * Short-descriptor format, all in domain 0 with full access.
+ */
+/*@{*/
+/** Section, normal memory, inner and outer write-back write-allocate. */
+#define NX__MMU_SECT_NORMAL 0x00001C0E
+/** Section, shareable device memory, execute never. */
+#define NX__MMU_SECT_DEVICE 0x00000C16
+/** First-level descriptor pointing to a coarse (second-level) table. */
+#define NX__MMU_COARSE 0x00000001
+/** Small page, normal memory, inner and outer write-back write-allocate. */
+#define NX__MMU_PAGE_NORMAL 0x0000007E
+/** Small page, shareable device memory, execute never. */
+#define NX__MMU_PAGE_DEVICE 0x00000037
+/** TTBR0 walk attributes: inner and outer write-back write-allocate. */
+#define NX__MMU_TTBR_ATTR 0x00000048
+/*@}*/
+
+/** @name PL310 L2 cache controller */
+/*@{*/
+#define NX__PL310_BASE 0xFFFEF000
+#define NX__PL310_CTRL 0x100 /**< Control register. */
+#define NX__PL310_SYNC 0x730 /**< Cache sync. */
+#define NX__PL310_INV_PA 0x770 /**< Invalidate line by physical address. */
+#define NX__PL310_INV_WAY 0x77C /**< Invalidate by way. */
+#define NX__PL310_CLEAN_PA 0x7B0 /**< Clean line by physical address. */
+#define NX__PL310_FLUSH_PA 0x7F0 /**< Clean and invalidate line by physical address. */
+#define NX__PL310_FLUSH_WAY 0x7FC /**< Clean and invalidate by way. */
+#define NX__PL310_WAYS_MASK 0xFF /**< 8 ways on the Cyclone V HPS. */
+/*@}*/
+
+#ifndef __ASSEMBLY__
+
+#include "base/cache.h"
+
+/** Build the translation table and turn on the MMU, the L1 and L2
+ * caches and branch prediction.
+ *
+ * @warning Called from the startup code, before any stack is set up.
+ */
+void nx__mmu_init(void);
+
+/** Write the whole L1 data cache back, and invalidate the instruction
+ * cache and branch predictor, after code was copied to RAM.
+ *
+ * @warning Called from the startup code, before any stack is set up.
+ */
+void nx__cache_sync_code_all(void);
+
+#endif /* __ASSEMBLY__ */
+
+/*@}*/
+/*@}*/
+
+#endif /* __NXOS_BASE__CACHE_H__ */
@@ -0,0 +1,44 @@
+/** @file _fpu.h
+ *  @brief Internal floating point unit definitions.
+ *
+ * This file is also included by the startup and interrupt code
+ * (init.S, interrupts.S, fpu.S).
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE__FPU_H__
+#define __NXOS_BASE__FPU_H__
+
+/** @addtogroup kernelinternal */
+/*@{*/
+
+/** @defgroup fpuinternal Floating point unit
+ */
+/*@{*/
+
+#define NX__CPACR_CP10_CP11_FULL (0xF << 20) /**< Full access to CP10 and CP11. */
+#define NX__FPEXC_EN (1 << 30) /**< Floating point unit enable. */
+
+/** @name Lazy context state layout
+ *
+ * Offsets in the nx__fpu_state structure (see fpu.S).
+ */
+/*@{*/
+#define NX__FPU_OWNER 0 /**< Context whose registers are in the FPU. */
+#define NX__FPU_CURRENT 4 /**< Context of the running code. */
+#define NX__FPU_IRQ_PREV 8 /**< Context interrupted by the current IRQ. */
+#define NX__FPU_IN_IRQ 12 /**< Non-zero while an IRQ handler runs. */
+#define NX__FPU_LOADS 16 /**< Number of lazy context loads. */
+/*@}*/
+
+/*@}*/
+/*@}*/
+
+#endif /* __NXOS_BASE__FPU_H__ */
@@ -25,18 +25,69 @@
     (((S32)pos) >= ((S32)start) && ((S32)pos) < ((S32)end)) && \
     (((S32)pos) + ((S32)len) <= ((S32)end))
 
-#ifdef __DE1SOC__
-void *_memcpy(void *dest, const void *src, size_t n) {
-  // FIXME: Naive implementation, no bounds checking
-  if (n == 0)
-    return NULL;
+#define WORD_MASK (sizeof(U32) - 1)
+
+/* Word type used to access byte buffers a word at a time. */
+typedef U32 __attribute__((may_alias)) word_t;
+
+/* Copy whole words from a source that is not word aligned: read
+ * aligned words, and merge adjacent ones with shifts (little endian).
+ * Reads never go past the aligned word holding the last source byte.
+ */
+static void memcpy_shifted(word_t *d, const U8 *s, U32 nwords) {
+  U32 rsh = ((U32)s & WORD_MASK) * 8;
+  U32 lsh = 32 - rsh;
+  const word_t *ws = (const word_t *)((U32)s & ~WORD_MASK);
+  U32 cur = *ws++;
+  U32 next;
+
+  while (nwords >= 2) {
+    next = *ws++;
+    *d++ = (cur >> rsh) | (next << lsh);
+    cur = *ws++;
+    *d++ = (next >> rsh) | (cur << lsh);
+    nwords -= 2;
+  }
+
+  if (nwords) {
+    next = *ws;
+    *d = (cur >> rsh) | (next << lsh);
+  }
+}
+
+void *nx__memcpy_ram(void *dest, const void *src, size_t n) {
+  U8 *d = dest;
+  const U8 *s = src;
+
+  if (n >= NX__MEMOPS_SMALL) {
+    /* Align the destination. */
+    while ((U32)d & WORD_MASK) {
+      *d++ = *s++;
+      n--;
+    }
+
+    if (((U32)s & WORD_MASK) == 0) {
+      nx__memcpy_words(d, s, n);
+      return dest;
+    }
+
+    memcpy_shifted((word_t *)d, s, n / sizeof(U32));
+    d += n & ~WORD_MASK;
+    s += n & ~WORD_MASK;
+    n &= WORD_MASK;
+  }
 
-  char *d = dest;
-  const char *s = src;
   while (n--)
-	*d++ = *s++;
+    *d++ = *s++;
+
   return dest;
 }
+
+#ifdef __DE1SOC__
+void *_memcpy(void *dest, const void *src, size_t n) {
+  // FIXME: no bounds checking
+  return nx__memcpy_ram(dest, src, n);
+}
 #endif
 
 #ifdef __LEGONXT__
@@ -61,13 +112,6 @@ typedef enum {
 
 #define AT91C_RELOC_START   0x00000000
 
-static void * memcpy_ram(U8 *dst, const U8 *src, U32 len) {
-  while (len--) {
-    *dst++ = *src++;
-  }
-  return dst;
-}
-
 static bool write_page(U32 page, U8 *buffer) {
   return nx__efc_write_page((U32 *)buffer, page);
 }
@@ -131,7 +175,7 @@ void *_memcpy(void *dest, const void *src, size_t n) {
   switch (belong) {
   case CHUNK_RAM:
   case CHUNK_RELOC_RAM:
-    return memcpy_ram((U8 *)dest, (U8 *)src, n);
+    return nx__memcpy_ram(dest, src, n);
     break;
   case CHUNK_RELOC_FLASH:
   case CHUNK_FLASH:
@@ -26,4 +26,34 @@
  */
 void *_memcpy(void *dest, const void *src, size_t n);
 
+/** Optimized forward memory copy, for RAM destinations.
+ *
+ * The destination is word aligned with a few byte copies, then the
+ * bulk of the data is moved with LDM/STM bursts (or with word shifts
+ * and merges if the source is not aligned like the destination).
+ * Overlapping buffers are only safe if @a dest < @a src.
+ *
+ * @param dest The destination buffer start address.
+ * @param src  The source buffer start address.
+ * @param n    Number of bytes to copy
+ *
+ * @return Pointer to destination buffer.
+ */
+void *nx__memcpy_ram(void *dest, const void *src, size_t n);
+
+/** @name Word-aligned block operations (see memops.S)
+ *
+ * Pointers must be word aligned, @a n may be any byte count.
+ */
+/*@{*/
+void nx__memcpy_words(void *dest, const void *src, U32 n);
+void nx__memcpy_words_back(void *dest_end, const void *src_end, U32 n);
+void nx__memset_words(void *dest, U32 pattern, U32 n);
+/*@}*/
+
+/** Buffers smaller than this are handled with plain byte loops, which
+ * beat the alignment setup cost.
+ */
+#define NX__MEMOPS_SMALL 16
+
 #endif /* __NXOS_BASE__MEMCPY_H__ */
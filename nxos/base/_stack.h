@@ -0,0 +1,44 @@
+/** @file _stack.h
+ *  @brief Internal stack measurement APIs.
+ *
+ * This file is also included by the startup code (init.S).
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE__STACK_H__
+#define __NXOS_BASE__STACK_H__
+
+/** @addtogroup kernelinternal */
+/*@{*/
+
+/** @defgroup stackinternal Stack usage
+ */
+/*@{*/
+
+/** The pattern used to paint unused stack memory. */
+#define NX__STACK_PAINT_VAL 0xC5C5C5C5
+
+#ifndef __ASSEMBLY__
+
+#include "base/stack.h"
+
+/** Periodic stack check, called once every millisecond.
+ *
+ * @warning This is called by the systick driver, and shouldn't be
+ * invoked directly unless you really know what you are doing.
+ */
+void nx__stack_check(void);
+
+#endif /* __ASSEMBLY__ */
+
+/*@}*/
+/*@}*/
+
+#endif /* __NXOS_BASE__STACK_H__ */
@@ -0,0 +1,172 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include "base/types.h"
+
+#include "base/_cache.h"
+
+#if defined(__DE1SOC__) && defined(__CACHEENABLE__)
+
+#define LINE_MASK (NX_CACHE_LINE_SIZE - 1)
+
+#define PL310_REG(offset) (*(HW_REG*)(NX__PL310_BASE + (offset)))
+
+/* L1 maintenance operations, by virtual address. The mapping is flat,
+ * so the same addresses are used for the L2, by physical address.
+ */
+#define DCIMVAC(addr) asm volatile("mcr p15, 0, %0, c7, c6, 1" : : "r" (addr) : "memory")
+#define DCCMVAC(addr) asm volatile("mcr p15, 0, %0, c7, c10, 1" : : "r" (addr) : "memory")
+#define DCCIMVAC(addr) asm volatile("mcr p15, 0, %0, c7, c14, 1" : : "r" (addr) : "memory")
+#define DCCMVAU(addr) asm volatile("mcr p15, 0, %0, c7, c11, 1" : : "r" (addr) : "memory")
+#define ICIMVAU(addr) asm volatile("mcr p15, 0, %0, c7, c5, 1" : : "r" (addr) : "memory")
+#define BPIALL() asm volatile("mcr p15, 0, %0, c7, c5, 6" : : "r" (0) : "memory")
+#define DSB() asm volatile("dsb" : : : "memory")
+#define ISB() asm volatile("isb" : : : "memory")
+
+typedef enum {
+  OP_CLEAN = 0,
+  OP_INVALIDATE,
+  OP_FLUSH,
+} cache_op_t;
+
+/* PL310 line operations by physical address complete before the
+ * register write does; only the final sync needs to be waited for.
+ */
+static void l2_sync(void) {
+  PL310_REG(NX__PL310_SYNC) = 0;
+  while (PL310_REG(NX__PL310_SYNC) & 1);
+}
+
+/* Apply an operation to the lines in [start, end), both line aligned.
+ *
+ * Write-backs go from L1 to L2 then memory; invalidations are done on
+ * the L2 first, so that the L1 cannot be refilled with stale data.
+ */
+static void range_op(cache_op_t op, U32 start, U32 end) {
+  U32 addr;
+
+  switch (op) {
+  case OP_CLEAN:
+    for (addr = start; addr < end; addr += NX_CACHE_LINE_SIZE)
+      DCCMVAC(addr);
+    DSB();
+    for (addr = start; addr < end; addr += NX_CACHE_LINE_SIZE)
+      PL310_REG(NX__PL310_CLEAN_PA) = addr;
+    l2_sync();
+    break;
+  case OP_INVALIDATE:
+    for (addr = start; addr < end; addr += NX_CACHE_LINE_SIZE)
+      PL310_REG(NX__PL310_INV_PA) = addr;
+    l2_sync();
+    for (addr = start; addr < end; addr += NX_CACHE_LINE_SIZE)
+      DCIMVAC(addr);
+    DSB();
+    break;
+  case OP_FLUSH:
+    for (addr = start; addr < end; addr += NX_CACHE_LINE_SIZE)
+      DCCIMVAC(addr);
+    DSB();
+    for (addr = start; addr < end; addr += NX_CACHE_LINE_SIZE)
+      PL310_REG(NX__PL310_FLUSH_PA) = addr;
+    l2_sync();
+    break;
+  }
+}
+
+bool nx_cache_enabled(void) {
+  U32 sctlr;
+
+  asm volatile("mrc p15, 0, %0, c1, c0, 0" : "=r" (sctlr));
+  return (sctlr & NX__SCTLR_C) ? TRUE : FALSE;
+}
+
+void nx_cache_clean_range(const void *addr, U32 size) {
+  if (size == 0)
+    return;
+
+  range_op(OP_CLEAN, (U32)addr & ~LINE_MASK,
+           ((U32)addr + size + LINE_MASK) & ~LINE_MASK);
+}
+
+void nx_cache_invalidate_range(void *addr, U32 size) {
+  U32 start = (U32)addr, end = (U32)addr + size;
+
+  if (size == 0)
+    return;
+
+  /* Lines only partly covered by the buffer may hold other dirty
+   * data: write them back instead of discarding them.
+   */
+  if (start & LINE_MASK) {
+    start &= ~LINE_MASK;
+    range_op(OP_FLUSH, start, start + NX_CACHE_LINE_SIZE);
+    start += NX_CACHE_LINE_SIZE;
+  }
+  if (end & LINE_MASK) {
+    end &= ~LINE_MASK;
+    if (end >= start)
+      range_op(OP_FLUSH, end, end + NX_CACHE_LINE_SIZE);
+  }
+
+  if (start < end)
+    range_op(OP_INVALIDATE, start, end);
+}
+
+void nx_cache_flush_range(void *addr, U32 size) {
+  if (size == 0)
+    return;
+
+  range_op(OP_FLUSH, (U32)addr & ~LINE_MASK,
+           ((U32)addr + size + LINE_MASK) & ~LINE_MASK);
+}
+
+void nx_cache_sync_code(void *addr, U32 size) {
+  U32 start = (U32)addr & ~LINE_MASK;
+  U32 end = ((U32)addr + size + LINE_MASK) & ~LINE_MASK;
+  U32 a;
+
+  /* The L2 is the point of unification: cleaning the L1 is enough. */
+  for (a = start; a < end; a += NX_CACHE_LINE_SIZE)
+    DCCMVAU(a);
+  DSB();
+  for (a = start; a < end; a += NX_CACHE_LINE_SIZE)
+    ICIMVAU(a);
+  BPIALL();
+  DSB();
+  ISB();
+}
+
+#else /* !(__DE1SOC__ && __CACHEENABLE__) */
+
+/* The caches are off: there is nothing to maintain. */
+
+bool nx_cache_enabled(void) {
+  return FALSE;
+}
+
+void nx_cache_clean_range(const void *addr, U32 size) {
+  (void)addr;
+  (void)size;
+}
+
+void nx_cache_invalidate_range(void *addr, U32 size) {
+  (void)addr;
+  (void)size;
+}
+
+void nx_cache_flush_range(void *addr, U32 size) {
+  (void)addr;
+  (void)size;
+}
+
+void nx_cache_sync_code(void *addr, U32 size) {
+  (void)addr;
+  (void)size;
+}
+
+#endif
@@ -0,0 +1,84 @@
+/** @file cache.h
+ *  @brief Cache maintenance for buffers shared with the FPGA.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_CACHE_H__
+#define __NXOS_BASE_CACHE_H__
+
+#include "base/types.h"
+
+/** @addtogroup kernel */
+/*@{*/
+
+/** @defgroup cache Caches
+ *
+ * When the kernel is built with @c CACHE=1 (DE1-SoC only), the startup
+ * code sets up a flat translation table and turns on the MMU, the L1
+ * instruction and data caches, branch prediction and the PL310 L2
+ * cache:
+ *
+ * - DDR and the A9 on-chip RAM are normal, write-back cacheable memory.
+ * - The FPGA memory window (SDRAM, on-chip memory, character buffer)
+ *   and the peripheral windows are device memory, never cached.
+ * - Everything else is unmapped, and faults on access.
+ *
+ * Buffers in DDR that the FPGA or another bus master reads or writes
+ * directly must be maintained by hand with the functions below. In
+ * other builds the caches are off, and these functions do nothing.
+ */
+/*@{*/
+
+/** Size in bytes of a cache line, in both L1 and L2. */
+#define NX_CACHE_LINE_SIZE 32
+
+/** Return TRUE if the data cache is enabled. */
+bool nx_cache_enabled(void);
+
+/** Write dirty cache lines back to memory.
+ *
+ * Use this after the CPU wrote a buffer that another bus master is
+ * about to read.
+ *
+ * @param addr The start of the buffer.
+ * @param size The size of the buffer in bytes.
+ */
+void nx_cache_clean_range(const void *addr, U32 size);
+
+/** Discard the cached copy of a buffer.
+ *
+ * Use this before the CPU reads a buffer that another bus master
+ * wrote. Partial cache lines at both ends are written back first, so
+ * that adjacent data is not lost; for best results, such buffers
+ * should be aligned on @ref NX_CACHE_LINE_SIZE.
+ *
+ * @param addr The start of the buffer.
+ * @param size The size of the buffer in bytes.
+ */
+void nx_cache_invalidate_range(void *addr, U32 size);
+
+/** Write a buffer back to memory and discard its cached copy.
+ *
+ * @param addr The start of the buffer.
+ * @param size The size of the buffer in bytes.
+ */
+void nx_cache_flush_range(void *addr, U32 size);
+
+/** Make code written by the CPU visible to instruction fetches.
+ *
+ * @param addr The start of the code.
+ * @param size The size of the code in bytes.
+ */
+void nx_cache_sync_code(void *addr, U32 size);
+
+/*@}*/
+/*@}*/
+
+#endif /* __NXOS_BASE_CACHE_H__ */
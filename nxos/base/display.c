@@ -10,6 +10,7 @@
 #include "base/interrupts.h"
 #include "base/util.h"
 #include "base/assert.h"
+#include "base/format.h"
 #include "base/drivers/systick.h"
 #include "base/drivers/aic.h"
 #include "base/drivers/_lcd.h"
@@ -28,10 +29,32 @@ static struct {
   /* The text display buffer, which is mirrored to the LCD controller's RAM. */
   U8 buffer[NX__DISPLAY_HEIGHT_CELLS][NX__DISPLAY_WIDTH_CELLS];		/* row major layout */
 
+  /* The buffer is a ring of rows, so that scrolling does not move
+   * them: this is the buffer row shown at the top of the screen.
+   */
+  U8 head;
+
   /* Whether the display is automatically refreshed after every call
    * to display functions. */
   bool auto_refresh;
 
+  /* Nesting depth of nx_display_begin() transactions. Refreshes are
+   * held back while it is non-zero. */
+  U8 batch;
+
+  /* Rows modified since they were last handed over to the LCD driver,
+   * one bit per row. */
+  U32 dirty_rows[NX__LCD_DIRTY_WORDS];
+
+#ifdef __DE1SOC__
+  /* Rows refreshed since they were last taken by the remote mirror,
+   * and the row the mirror looks at first next time.
+   */
+  bool mirror;
+  U32 mirror_rows[NX__LCD_DIRTY_WORDS];
+  U8 mirror_next;
+#endif
+
   /* If true, the display scrolls after a newline in the last line,
    * otherwise it simply wraps to the beginning. */
   bool scroll_ok;
@@ -49,17 +72,55 @@ static struct {
 } display;
 
 
+/* The buffer row holding screen row y. */
+static inline U8 *row_ptr(U8 y) {
+  U32 row = display.head + y;
+
+  if (row >= NX__DISPLAY_HEIGHT_CELLS)
+    row -= NX__DISPLAY_HEIGHT_CELLS;
+  return display.buffer[row];
+}
+
+static inline void dirty_row(U8 y) {
+  display.dirty_rows[y / 32] |= (U32)1 << (y % 32);
+}
+
+static void dirty_all_rows(void) {
+  U8 y;
+
+  for (y = 0; y < NX__DISPLAY_HEIGHT_CELLS; y++)
+    dirty_row(y);
+}
+
+/* Hand the modified rows over to the LCD driver. */
+static void flush_rows(void) {
+  U32 w;
+
+  nx__lcd_dirty_rows(display.dirty_rows);
+  for (w = 0; w < NX__LCD_DIRTY_WORDS; w++) {
+#ifdef __DE1SOC__
+    if (display.mirror)
+      display.mirror_rows[w] |= display.dirty_rows[w];
+#endif
+    display.dirty_rows[w] = 0;
+  }
+}
+
 static inline void dirty_display(void) {
-  if (display.auto_refresh)
-    nx__lcd_dirty_display();
+  if (display.auto_refresh && display.batch == 0)
+    flush_rows();
 }
 
 
 /* Clear the display. */
 void nx_display_clear(void) {
+  nx_display_begin();
   memset(&display.buffer[0][0], 0, sizeof(display.buffer));
+  display.head = 0;
+  nx__lcd_set_first_row(0);
   nx_display_cursor_set_pos(0, 0);
-  dirty_display();
+  dirty_all_rows();
+  nx_display_commit();
 }
 
 
@@ -69,6 +130,22 @@ void nx_display_auto_refresh(bool auto_refresh) {
   dirty_display();
 }
 
+/* Start and end a batch of display updates. The LCD driver does not
+ * mirror the buffer while a batch is open, so that it never copies a
+ * half-written row.
+ */
+void nx_display_begin(void) {
+  if (display.batch++ == 0)
+    nx__lcd_hold(TRUE);
+}
+
+void nx_display_commit(void) {
+  NX_ASSERT(display.batch > 0);
+  if (--display.batch == 0)
+    nx__lcd_hold(FALSE);
+  dirty_display();
+}
+
 /* Enable or disable display scrolling */
 void nx_display_scroll_ok(bool enable) {
   display.scroll_ok = enable;
@@ -79,7 +156,52 @@ void nx_display_scroll_ok(bool enable) {
  * auto-refresh is disabled.
  */
 inline void nx_display_refresh(void) {
-  nx__lcd_dirty_display();
+  flush_rows();
+}
+
+#ifdef __DE1SOC__
+void nx_display_mirror_enable(bool enable) {
+  U32 w;
+
+  /* A new mirror needs the whole screen. */
+  for (w = 0; w < NX__LCD_DIRTY_WORDS; w++)
+    display.mirror_rows[w] = enable ? 0xFFFFFFFF : 0;
+  display.mirror_next = 0;
+  display.mirror = enable;
+}
+
+S32 nx_display_mirror_take(const U8 **cells, U32 *len) {
+  U32 i, y, bit;
+
+  if (!display.mirror)
+    return -1;
+
+  /* Round robin from the row after the last one taken, so that a
+   * frequently updated row does not starve the others.
+   */
+  for (i = 0, y = display.mirror_next; i < NX__DISPLAY_HEIGHT_CELLS; i++) {
+    bit = (U32)1 << (y % 32);
+    if (display.mirror_rows[y / 32] & bit) {
+      display.mirror_rows[y / 32] &= ~bit;
+      display.mirror_next = (y + 1 < NX__DISPLAY_HEIGHT_CELLS) ? y + 1 : 0;
+      *cells = row_ptr(y);
+      *len = NX__DISPLAY_WIDTH_CELLS;
+      return y;
+    }
+    if (++y == NX__DISPLAY_HEIGHT_CELLS)
+      y = 0;
+  }
+
+  return -1;
+}
+#endif
+
+void nx_display_set_refresh(U32 max_rate_hz, U32 row_budget) {
+  nx__lcd_set_refresh(max_rate_hz, row_budget);
+}
+
+void nx_display_flush(void) {
+  nx__lcd_flush();
 }
 
 
@@ -104,6 +226,23 @@ static inline const U8 *char_to_font(const char c) {
 }
 #endif
 
+#ifdef __DE1SOC__
+#define CELL_BYTES 1
+#endif
+#ifdef __LEGONXT__
+#define CELL_BYTES NX__CELL_WIDTH
+#endif
+
+/* Draw character c in the cell (x, y). */
+static inline void put_cell(U8 x, U8 y, char c) {
+#ifdef __DE1SOC__
+  row_ptr(y)[x] = c;
+#endif
+#ifdef __LEGONXT__
+  memcpy(row_ptr(y) + x * NX__CELL_WIDTH, char_to_font(c), NX__FONT_WIDTH);
+#endif
+}
+
 static inline void update_cursor(bool inc_y) {
   if (!inc_y) {
     display.cursor.x++;
@@ -124,11 +263,18 @@ static inline void update_cursor(bool inc_y) {
 
   if (display.cursor.y >= NX__DISPLAY_HEIGHT_CELLS) {
     if (display.scroll_ok) {
-      memcpy(&display.buffer[0][0], &display.buffer[1][0],
-             sizeof(display.buffer) - sizeof(display.buffer[0]));
-      memset(&display.buffer[NX__DISPLAY_HEIGHT_CELLS-1], 0, sizeof(display.buffer[0]));
+      /* The top row becomes the new bottom row. Every screen row now
+       * shows different contents, but the buffer itself only changes
+       * by one row.
+       */
+      nx_display_begin();
+      memset(row_ptr(0), 0, sizeof(display.buffer[0]));
+      if (++display.head == NX__DISPLAY_HEIGHT_CELLS)
+        display.head = 0;
+      nx__lcd_set_first_row(display.head);
       display.cursor.y = NX__DISPLAY_HEIGHT_CELLS - 1;
-      dirty_display();
+      dirty_all_rows();
+      nx_display_commit();
     } else {
       display.cursor.y = 0;
     }
@@ -154,26 +300,96 @@ inline void nx_display_end_line(void) {
 }
 
 void nx_display_string(const char *str) {
+  nx_display_begin();
   while (*str != '\0') {
     if (*str == '\n')
       update_cursor(TRUE);
     else {
-
-#ifdef __DE1SOC__
-    		memcpy(&display.buffer[display.cursor.y][display.cursor.x],
-    				str, sizeof(char));
-#endif
-
-#ifdef __LEGONXT__
-    		int x_offset = display.cursor.x * NX__CELL_WIDTH;
-    		memcpy(&display.buffer[display.cursor.y][x_offset],
-    				char_to_font(*str), NX__FONT_WIDTH);
-#endif
+      dirty_row(display.cursor.y);
+      put_cell(display.cursor.x, display.cursor.y, *str);
       update_cursor(FALSE);
     }
     str++;
   }
-  dirty_display();
+  nx_display_commit();
+}
+
+void nx_display_write_at(U8 x, U8 y, const char *buf, U32 len) {
+  U32 i;
+
+  NX_ASSERT(is_on_screen(x, y));
+  len = MIN(len, (U32)(NX__DISPLAY_WIDTH_CELLS - x));
+  if (len == 0)
+    return;
+
+  nx_display_begin();
+  for (i = 0; i < len; i++)
+    put_cell(x + i, y, buf[i]);
+  dirty_row(y);
+  nx_display_commit();
+}
+
+void nx_display_erase(U8 x, U8 y, U32 len) {
+  NX_ASSERT(is_on_screen(x, y));
+  len = MIN(len, (U32)(NX__DISPLAY_WIDTH_CELLS - x));
+  if (len == 0)
+    return;
+
+  nx_display_begin();
+  memset(row_ptr(y) + x * CELL_BYTES, 0, len * CELL_BYTES);
+  dirty_row(y);
+  nx_display_commit();
+}
+
+void nx_display_scroll_region(U8 top, U8 bottom, S32 lines) {
+  U32 height, n, y;
+
+  NX_ASSERT(top <= bottom && bottom < NX__DISPLAY_HEIGHT_CELLS);
+  height = bottom - top + 1;
+  n = (lines < 0) ? (U32)-lines : (U32)lines;
+  if (n == 0)
+    return;
+  n = MIN(n, height);
+
+  nx_display_begin();
+  if (height == NX__DISPLAY_HEIGHT_CELLS) {
+    /* The whole screen: rotate the ring of rows instead of moving
+     * them, then blank the rows scrolled in.
+     */
+    if (lines > 0) {
+      display.head = (display.head + n) % NX__DISPLAY_HEIGHT_CELLS;
+      for (y = height - n; y < height; y++)
+        memset(row_ptr(y), 0, sizeof(display.buffer[0]));
+    } else {
+      display.head = (display.head + NX__DISPLAY_HEIGHT_CELLS - n)
+        % NX__DISPLAY_HEIGHT_CELLS;
+      for (y = 0; y < n; y++)
+        memset(row_ptr(y), 0, sizeof(display.buffer[0]));
+    }
+    nx__lcd_set_first_row(display.head);
+  } else if (lines > 0) {
+    for (y = top; y + n <= bottom; y++)
+      memcpy(row_ptr(y), row_ptr(y + n), sizeof(display.buffer[0]));
+    for (; y <= bottom; y++)
+      memset(row_ptr(y), 0, sizeof(display.buffer[0]));
+  } else {
+    for (y = bottom; y >= top + n; y--)
+      memcpy(row_ptr(y), row_ptr(y - n), sizeof(display.buffer[0]));
+    for (y = top; y < top + n; y++)
+      memset(row_ptr(y), 0, sizeof(display.buffer[0]));
+  }
+
+  for (y = top; y <= bottom; y++)
+    dirty_row(y);
+  nx_display_commit();
+}
+
+U8 nx_display_get_width(void) {
+  return NX__DISPLAY_WIDTH_CELLS;
+}
+
+U8 nx_display_get_height(void) {
+  return NX__DISPLAY_HEIGHT_CELLS;
 }
 
 void nx_display_hex(U32 val) {
@@ -199,38 +415,31 @@ void nx_display_hex(U32 val) {
   buf[8] = '\0';
 
   nx_display_string(ptr);
-  dirty_display();
 }
 
 void nx_display_uint(U32 val) {
   char buf[11];
-  char *ptr = &buf[10];
 
-  if (val == 0) {
-    ptr--;
-    *ptr = '0';
-  } else {
+  nx_snprintf(buf, sizeof(buf), "%lu", val);
+  nx_display_string(buf);
+}
 
-    while (val > 0) {
-      ptr--;
-      *ptr = val % 10 + '0';
-      val /= 10;
-    }
+void nx_display_int(S32 val) {
+  char buf[12];
 
-  }
+  nx_snprintf(buf, sizeof(buf), "%ld", val);
+  nx_display_string(buf);
+}
 
-  buf[10] = '\0';
+void nx_display_printf(const char *fmt, ...) {
+  char buf[NX_PRINTF_BUFSIZE];
+  va_list ap;
 
-  nx_display_string(ptr);
-  dirty_display();
-}
+  va_start(ap, fmt);
+  nx_vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
 
-void nx_display_int(S32 val) {
-  if( val < 0 ) {
-    nx_display_string("-");
-    val = -val;
-  }
-  nx_display_uint(val);
+  nx_display_string(buf);
 }
 
 /*
@@ -238,6 +447,10 @@ void nx_display_int(S32 val) {
  */
 void nx__display_init(void) {
   display.auto_refresh = FALSE;
+  display.batch = 0;
+#ifdef __DE1SOC__
+  display.mirror = FALSE;
+#endif
   nx_display_clear();
   display.cursor.x = 0;
   display.cursor.y = 0;
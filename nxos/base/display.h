@@ -35,6 +35,19 @@
  * anything to the screen, the physical LCD is automatically refreshed.
  * Auto-refresh can be disabled, in which case the physical screen will
  * only refresh itself on an explicit call to nx_display_refresh().
+ *
+ * Only the rows that were written to are refreshed. To group several
+ * writes into a single refresh, surround them with nx_display_begin()
+ * and nx_display_commit().
+ *
+ * On the DE1-SoC, refreshed rows are mirrored to the screen from idle
+ * context rather than from the system timer interrupt: while waiting
+ * in nx_systick_wait_ms(), or on calls to nx_display_flush(). Each
+ * flush copies a bounded number of rows, and the refresh rate is
+ * capped (60 Hz and 8 rows per flush by default, see
+ * nx_display_set_refresh()). Should the application not give the
+ * display any idle time, the timer interrupt takes over after a short
+ * delay, within the same limits.
  */
 /*@{*/
 
@@ -57,6 +70,18 @@ void nx_display_auto_refresh(bool auto_refresh);
  */
 void nx_display_scroll_ok(bool enable) ;
 
+/** Start a batch of display updates.
+ *
+ * Until the matching nx_display_commit(), the display functions only
+ * record which rows they modify, and the screen is not refreshed. The
+ * rows modified by the whole batch are then refreshed at once. Batches
+ * can be nested: only the outermost commit refreshes the screen.
+ */
+void nx_display_begin(void);
+
+/** End a batch of display updates started with nx_display_begin(). */
+void nx_display_commit(void);
+
 /** Start a display refresh cycle.
  *
  * @note This call has very little effect if the display is in
@@ -66,6 +91,49 @@ void nx_display_scroll_ok(bool enable) ;
  */
 void nx_display_refresh(void);
 
+/** Set the refresh policy of the screen.
+ *
+ * @param max_rate_hz The maximum number of screen refreshes per
+ * second, or 0 for no limit.
+ * @param row_budget The maximum number of rows mirrored per flush, or
+ * 0 for no limit.
+ *
+ * @note This has no effect on the NXT, whose screen is refreshed by
+ * DMA.
+ */
+void nx_display_set_refresh(U32 max_rate_hz, U32 row_budget);
+
+/** Mirror pending rows to the screen, within the refresh policy.
+ *
+ * Call this regularly from application loops that do not otherwise
+ * wait, to keep the screen up to date with low latency.
+ */
+void nx_display_flush(void);
+
+#ifdef __DE1SOC__
+/** Start or stop tracking rows for a remote mirror of the display.
+ *
+ * While enabled, every row refreshed on the screen is also queued for
+ * the mirror, which takes them with nx_display_mirror_take(). Enabling
+ * queues all the rows. See the mirror library for a mirror over the
+ * UART.
+ *
+ * @param enable TRUE to start tracking, FALSE to stop.
+ */
+void nx_display_mirror_enable(bool enable);
+
+/** Take the next row queued for the remote mirror.
+ *
+ * @param cells Set to the characters of the row, in the display
+ * buffer itself: they are only valid until the next display call.
+ * @param len Set to the number of characters of the row.
+ *
+ * @return The row, counted from the top of the screen, or -1 if no
+ * row is queued.
+ */
+S32 nx_display_mirror_take(const U8 **cells, U32 *len);
+#endif
+
 /** Returns the x cursor position. */
 U8 nx_display_cursor_get_pos_x(void);
 
@@ -94,6 +162,44 @@ void nx_display_end_line(void);
  */
 void nx_display_string(const char *str);
 
+/** Display @a len characters of @a buf from cell (@a x, @a y).
+ *
+ * The text is clipped at the end of the line. The cursor does not
+ * move, and newlines are not interpreted.
+ *
+ * @param x The column of the first character.
+ * @param y The line of the text.
+ * @param buf The characters to display.
+ * @param len The number of characters.
+ */
+void nx_display_write_at(U8 x, U8 y, const char *buf, U32 len);
+
+/** Blank @a len cells from cell (@a x, @a y), up to the end of the line.
+ *
+ * @param x The column of the first cell.
+ * @param y The line of the cells.
+ * @param len The number of cells.
+ */
+void nx_display_erase(U8 x, U8 y, U32 len);
+
+/** Scroll the lines @a top to @a bottom by @a lines.
+ *
+ * The other lines do not move. Lines scrolled in are blank. Scrolling
+ * the whole screen is cheap whatever @a lines.
+ *
+ * @param top The first line of the region.
+ * @param bottom The last line of the region.
+ * @param lines The number of lines to scroll up by, or down by if
+ * negative.
+ */
+void nx_display_scroll_region(U8 top, U8 bottom, S32 lines);
+
+/** Return the width of the display, in characters. */
+U8 nx_display_get_width(void);
+
+/** Return the height of the display, in lines. */
+U8 nx_display_get_height(void);
+
 /** Display @a val as a hexadecimal number.
  *
  * @param val The number to display in hex.
@@ -112,6 +218,17 @@ void nx_display_uint(U32 val);
  */
 void nx_display_int(S32 val);
 
+/** Display formatted output at the current cursor position.
+ *
+ * See nx_snprintf() for the format. The screen is refreshed once for
+ * the whole output, which is truncated to NX_PRINTF_BUFSIZE - 1
+ * characters.
+ *
+ * @param fmt The format string.
+ */
+void nx_display_printf(const char *fmt, ...)
+  __attribute__((format(printf, 1, 2)));
+
 /*@}*/
 /*@}*/
 
@@ -24,6 +24,17 @@
 /** Initialize the interrupt controller. */
 void nx__aic_init(void);
 
+#ifdef __DE1SOC__
+/** An entry of the IRQ dispatcher's vector table (see ivr_table.S). */
+typedef struct {
+  U32 id; /**< GIC interrupt ID, or NX__AIC_INVALID_ID if free. */
+  nx_closure_t isr; /**< Interrupt handler. */
+  U32 count; /**< Number of dispatches to the entry. */
+} nx__aic_vector_entry_t;
+
+#define NX__AIC_INVALID_ID 0xFFFFFFFF /**< ID of free and guard entries. */
+#endif
+
 /*@}*/
 /*@}*/
 
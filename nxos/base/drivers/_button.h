@@ -27,6 +27,9 @@
 #define BUTTON_2_MASK 0x04		/**< Bitmask for button 2 status */
 #define BUTTON_3_MASK 0x08		/**< Bitmask for button 3 status */
 
+#define BUTTON_DATA_INDEX 0		/**< Button state register (KEY_BASE word index) */
+#define BUTTON_EDGECAPTURE_INDEX 3	/**< Edge capture register (KEY_BASE word index) */
+
 /** Initialize the button driver. */
 void nx_de1_button_init(void);
 
@@ -0,0 +1,47 @@
+/** @file _fb.h
+ *  @brief Pixel framebuffer internal interface.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_DRIVERS__FB_H__
+#define __NXOS_BASE_DRIVERS__FB_H__
+
+#include "base/drivers/fb.h"
+
+/** @addtogroup driverinternal */
+/*@{*/
+
+/** @defgroup fbinternal Pixel framebuffer */
+/*@{*/
+
+/** @name Pixel buffer DMA controller registers
+ *
+ * Word indexes from PIXEL_BUF_CTRL_BASE.
+ */
+/*@{*/
+#define NX__FB_FRONT_INDEX 0 /**< Front buffer address; a write requests a swap. */
+#define NX__FB_BACK_INDEX 1 /**< Back buffer address. */
+#define NX__FB_RES_INDEX 2 /**< Resolution: height << 16 | width. */
+#define NX__FB_STATUS_INDEX 3 /**< Status. */
+/*@}*/
+
+#define NX__FB_STATUS_SWAP 0x1 /**< Set until a requested swap is done. */
+
+/** Size of a frame buffer in bytes. */
+#define NX__FB_SIZE (NX_FB_STRIDE * NX_FB_HEIGHT * sizeof(U16))
+
+/** The two frame buffers, in the FPGA SDRAM. */
+#define NX__FB_BUFFER0 (SDRAM_BASE)
+#define NX__FB_BUFFER1 (SDRAM_BASE + NX__FB_SIZE)
+
+/*@}*/
+/*@}*/
+
+#endif /* __NXOS_BASE_DRIVERS__FB_H__ */
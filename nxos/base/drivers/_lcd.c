@@ -18,6 +18,7 @@
 #include "base/types.h"
 #include "base/lock.h"
 #include "base/util.h"
+#include "base/memmap.h"
 
 #include "base/interrupts.h"
 #include "base/drivers/systick.h"
@@ -27,17 +28,55 @@
 
 #ifdef __DE1SOC__
 
+/* Default refresh policy: at most 60 frames per second, mirroring at
+ * most 8 rows per flush slot.
+ */
+#define DEFAULT_MAX_RATE_HZ 60
+#define DEFAULT_ROW_BUDGET 8
+
+/* If no idle flush ran for this long while rows are dirty, the systick
+ * handler takes over the flushing, within the same budget.
+ */
+#define STARVATION_MS 50
+
 static volatile struct {
 
   /* A pointer to the in-memory screen framebuffer to mirror to
-   * screen, and a flag stating whether the in-memory buffer is dirty
-   * (new content needs mirroring to the LCD device.
+   * screen, and a bitmap of its rows that are dirty (new content
+   * needs mirroring to the LCD device).
    */
   U8 *screen;
-  bool screen_dirty;
-} lcd_state = {
+  U32 dirty_rows[NX__LCD_DIRTY_WORDS];
+
+  /* The screen buffer is a ring of rows: this one is shown first. */
+  U32 first_row;
+
+  /* Non-zero while the display code is modifying the screen buffer. */
+  U8 hold;
+
+  /* The current frame: whether one is in progress, when it started and
+   * the next row to look at. A frame is a pass over all rows, spread
+   * over as many flush slots as the row budget requires.
+   */
+  bool in_frame;
+  U32 frame_start;
+  U32 next_row;
+
+  /* Last time the flush ran from idle context. */
+  U32 last_idle;
+
+  /* Refresh policy. */
+  U32 min_interval_ms;
+  U32 row_budget;
+} lcd_state NX_FAST_DATA = {
   NULL,
-  FALSE
+  { 0 },
+  0,
+  0,
+  FALSE, 0, 0,
+  0,
+  (1000 + DEFAULT_MAX_RATE_HZ - 1) / DEFAULT_MAX_RATE_HZ,
+  DEFAULT_ROW_BUDGET
 };
 
 /** Initialize the LCD driver. */
@@ -55,35 +94,106 @@ void nx__lcd_init(void) {
 
 }
 
+static inline bool rows_dirty(void) {
+	U32 w;
+
+	for (w = 0; w < NX__LCD_DIRTY_WORDS; w++)
+		if (lcd_state.dirty_rows[w])
+			return TRUE;
+	return FALSE;
+}
+
+/* Mirror one row if it is dirty. Writers may run in interrupt
+ * context, so outside of it the dirty bit is taken and the row copied
+ * with interrupts disabled: the device gets either the old or the new
+ * contents of the row, never a mix.
+ */
+static NX_FAST bool flush_row(U32 row, bool in_isr) {
+	U32 bit = (U32)1 << (row % 32);
+	bool copied = FALSE;
+
+	if (!in_isr)
+		nx_interrupts_disable();
+	if (lcd_state.dirty_rows[row / 32] & bit) {
+		lcd_state.dirty_rows[row / 32] &= ~bit;
+		// FIXME: We only copy the text buffer for now
+		memcpy((U8 *)FPGA_CHAR_BASE + row * NX__TXTBUF_ROW_INCR,
+		       lcd_state.screen + ((lcd_state.first_row + row) %
+		                           NX__DISPLAY_HEIGHT_CELLS) * NX__DISPLAY_WIDTH_CELLS,
+		       NX__DISPLAY_WIDTH_CELLS);
+		copied = TRUE;
+	}
+	if (!in_isr)
+		nx_interrupts_enable();
+
+	return copied;
+}
+
+/* One flush slot: mirror up to row_budget dirty rows of the current
+ * frame, starting a new frame only if the rate limit allows it.
+ */
+static NX_FAST void flush_slot(bool in_isr) {
+	U32 now = nx_systick_get_ms();
+	U32 copied = 0;
+
+	if (lcd_state.screen == NULL || lcd_state.hold)
+		return;
+
+	if (!lcd_state.in_frame) {
+		if (!rows_dirty() ||
+		    now - lcd_state.frame_start < lcd_state.min_interval_ms)
+			return;
+		lcd_state.in_frame = TRUE;
+		lcd_state.frame_start = now;
+		lcd_state.next_row = 0;
+	}
+
+	while (lcd_state.next_row < NX__DISPLAY_HEIGHT_CELLS &&
+	       copied < lcd_state.row_budget) {
+		if (flush_row(lcd_state.next_row, in_isr))
+			copied++;
+		lcd_state.next_row++;
+	}
+
+	/* Rows dirtied behind the cursor are left for the next frame. */
+	if (lcd_state.next_row >= NX__DISPLAY_HEIGHT_CELLS)
+		lcd_state.in_frame = FALSE;
+}
+
 /** Periodic update function, called once every millisecond.
+ *
+ * The screen is normally mirrored from idle context by nx__lcd_flush().
+ * This only steps in if the application has not let it run for a
+ * while.
  *
  * @warning This is called by the systick driver, and shouldn't be
  * invoked directly unless you really know what you are doing.
  */
-void nx__lcd_fast_update(void) {
+NX_FAST void nx__lcd_fast_update(void) {
+	if (nx_systick_get_ms() - lcd_state.last_idle >= STARVATION_MS)
+		flush_slot(TRUE);
+}
 
-	/* Atomically retrieve the dirty flag and set it to FALSE. This is
-	 * to avoid race conditions where a set of the dirty flag could
-	 * get squashed by the interrupt handler resetting it.
-	 */
-	// FIXME: swpb not implemented by CPUlator
-	// bool dirty = nx_atomic_cas8((U8*)&(lcd_state.screen_dirty), FALSE);
-	bool dirty = lcd_state.screen_dirty;
-	lcd_state.screen_dirty = FALSE;
-
-	if (dirty) {
-	  // FIXME: We only copy the text buffer for now
-	  U8 *txt_buf_row = (U8 *)(HW_REG *) FPGA_CHAR_BASE;
-	  U8 *txt_src_row = lcd_state.screen;
-
-	  int row;
-	  for (row = 0; row < NX__DISPLAY_HEIGHT_CELLS; row++) {
-		  memcpy((void *)txt_buf_row, txt_src_row, NX__DISPLAY_WIDTH_CELLS);
-		  txt_buf_row += NX__TXTBUF_ROW_INCR;
-		  txt_src_row += NX__DISPLAY_WIDTH_CELLS;
-	  }
+/** Mirror the next slot of dirty rows, from idle context. */
+void nx__lcd_flush(void) {
+	lcd_state.last_idle = nx_systick_get_ms();
+	flush_slot(FALSE);
+}
 
-  }
+/** Set the refresh policy. */
+void nx__lcd_set_refresh(U32 max_rate_hz, U32 row_budget) {
+	nx_interrupts_disable();
+	lcd_state.min_interval_ms = max_rate_hz ? (1000 + max_rate_hz - 1) / max_rate_hz : 0;
+	lcd_state.row_budget = row_budget ? row_budget : NX__DISPLAY_HEIGHT_CELLS;
+	nx_interrupts_enable();
+}
+
+/** Hold or release flushes while the screen buffer is modified. */
+void nx__lcd_hold(bool hold) {
+	if (hold)
+		lcd_state.hold++;
+	else
+		lcd_state.hold--;
 }
 
 /** Set the virtual display to mirror to the screen.
@@ -94,10 +204,26 @@ void nx__lcd_set_display(U8 *display_buffer) {
   lcd_state.screen = display_buffer;
 }
 
+/** Set the buffer row shown at the top of the screen. */
+void nx__lcd_set_first_row(U32 row) {
+  lcd_state.first_row = row;
+}
+
 /** Mark the display as requiring a refresh cycle. */
 void nx__lcd_dirty_display(void) {
-  lcd_state.screen_dirty = TRUE;
+  U32 w;
 
+  for (w = 0; w < NX__LCD_DIRTY_WORDS; w++)
+    lcd_state.dirty_rows[w] = 0xFFFFFFFF;
+}
+
+/** Mark some rows of the display as requiring a refresh cycle. */
+void nx__lcd_dirty_rows(const U32 rows[NX__LCD_DIRTY_WORDS]) {
+  U32 w;
+
+  /* Racing with a flush at worst leaves a clean row marked dirty. */
+  for (w = 0; w < NX__LCD_DIRTY_WORDS; w++)
+    lcd_state.dirty_rows[w] |= rows[w];
 }
 
 /** Safely power off the LCD controller.
@@ -117,7 +243,18 @@ void nx__lcd_shutdown(void) {
  * after displaying an abort message.
  */
 void nx__lcd_sync_refresh(void) {
+	U32 row;
+
+	if (lcd_state.screen == NULL)
+		return;
 
+	/* Interrupts are already disabled by the abort handler. Copy every
+	 * row: with auto refresh off, the display never marked its rows
+	 * dirty here.
+	 */
+	nx__lcd_dirty_display();
+	for (row = 0; row < NX__DISPLAY_HEIGHT_CELLS; row++)
+		flush_row(row, TRUE);
 }
 
 #endif
@@ -168,6 +305,9 @@ static volatile struct {
   U8 *screen;
   bool screen_dirty;
 
+  /* The screen buffer is a ring of pages: this one is shown first. */
+  U8 first_row;
+
   /* State used by the display update code to manage the DMA
    * transfer. */
   U8 *data;
@@ -177,6 +317,7 @@ static volatile struct {
   COMMAND, /* We're initialized in command tx mode */
   NULL,    /* No screen buffer */
   FALSE,   /* ... So obviously not dirty */
+  0,       /* Ring starts at the 1st page */
   NULL,    /* No current refresh data pointer */
   0,       /* Current state: 1st data page... */
   FALSE    /* And about to send display data */
@@ -229,7 +370,8 @@ static void spi_isr(void) {
      * get squashed by the interrupt handler resetting it.
      */
     bool dirty = nx_atomic_cas8((U8*)&(spi_state.screen_dirty), FALSE);
-    spi_state.data = dirty ? spi_state.screen: NULL;
+    spi_state.data = (dirty && spi_state.screen) ?
+      spi_state.screen + spi_state.first_row * 100 : NULL;
 
     /* If the screen is not dirty, or if there is no screen pointer to
      * source data from, then shut down the DMA refresh interrupt
@@ -266,11 +408,12 @@ static void spi_isr(void) {
      * Given that this data is off-screen, we just resend the last 32
      * bytes of the 100 we just transferred.
      */
+    *AT91C_SPI_TNPR = (U32)(spi_state.data + 100 - 32);
+    *AT91C_SPI_TNCR = 32;
     spi_state.page = (spi_state.page + 1) % 8;
-    spi_state.data += 100;
+    spi_state.data = spi_state.screen +
+      ((spi_state.first_row + spi_state.page) % 8) * 100;
     spi_state.send_padding = FALSE;
-    *AT91C_SPI_TNPR = (U32)(spi_state.data - 32);
-    *AT91C_SPI_TNCR = 32;
   }
 }
 
@@ -406,10 +549,35 @@ void nx__lcd_set_display(U8 *display) {
   *AT91C_SPI_IER = AT91C_SPI_ENDTX;
 }
 
+void nx__lcd_set_first_row(U32 row) {
+  spi_state.first_row = row;
+}
+
 void nx__lcd_dirty_display(void) {
   spi_state.screen_dirty = TRUE;
 }
 
+void nx__lcd_dirty_rows(const U32 rows[NX__LCD_DIRTY_WORDS]) {
+  /* The whole screen is sent by DMA anyway. */
+  if (rows[0])
+    spi_state.screen_dirty = TRUE;
+}
+
+/* The refresh is a DMA transfer started from the systick handler, so
+ * there is nothing to defer to idle time.
+ */
+void nx__lcd_flush(void) {
+}
+
+void nx__lcd_set_refresh(U32 max_rate_hz, U32 row_budget) {
+  (void)max_rate_hz;
+  (void)row_budget;
+}
+
+void nx__lcd_hold(bool hold) {
+  (void)hold;
+}
+
 void nx__lcd_shutdown(void) {
   /* When power to the controller goes out, there is the risk that
    * some capacitors mounted around the controller might damage it
@@ -440,7 +608,7 @@ void nx__lcd_sync_refresh() {
       while (!(*AT91C_SPI_SR & AT91C_SPI_TDRE));
 
       /* Send the command byte and wait for a reply. */
-      *AT91C_SPI_TDR = spi_state.screen[i*100 + j];
+      *AT91C_SPI_TDR = spi_state.screen[((spi_state.first_row + i) % 8)*100 + j];
     }
   }
 }
@@ -50,6 +50,9 @@
 
 /** Row Address Increment of the text display, in number of bytes. */
 #define NX__TXTBUF_ROW_INCR 0x80
+
+/** Number of 32-bit words in a dirty row bitmap. */
+#define NX__LCD_DIRTY_WORDS ((NX__DISPLAY_HEIGHT_CELLS + 31) / 32)
 #endif
 
 
@@ -58,27 +61,79 @@
 #define LCD_WIDTH 100
 /** Height of the B/W LCD display, in pixels. */
 #define LCD_HEIGHT 64
+
+/** Number of 32-bit words in a dirty row bitmap. */
+#define NX__LCD_DIRTY_WORDS 1
 #endif
 
 /** Initialize the LCD driver. */
 void nx__lcd_init(void);
 
 /** Periodic update function, called once every millisecond.
+ *
+ * On the DE1-SoC, the screen is mirrored by nx__lcd_flush(); this only
+ * flushes rows itself if no idle flush ran for a while.
  *
  * @warning This is called by the systick driver, and shouldn't be
  * invoked directly unless you really know what you are doing.
  */
 void nx__lcd_fast_update(void);
 
+/** Mirror the next slot of dirty rows to the screen.
+ *
+ * Call this from idle context, e.g. while busy waiting. Each call
+ * copies at most the configured number of rows, and resumes the
+ * current refresh cycle where the previous call stopped. A new
+ * refresh cycle only starts if the maximum refresh rate allows it.
+ */
+void nx__lcd_flush(void);
+
+/** Set the refresh policy of nx__lcd_flush().
+ *
+ * @param max_rate_hz The maximum number of refresh cycles per second,
+ * or 0 for no limit.
+ * @param row_budget The maximum number of rows copied per flush slot,
+ * or 0 for no limit.
+ */
+void nx__lcd_set_refresh(U32 max_rate_hz, U32 row_budget);
+
+/** Hold back flushes while the screen buffer is being modified.
+ *
+ * Calls nest: flushing resumes when every hold has been released.
+ *
+ * @param hold TRUE to hold, FALSE to release.
+ */
+void nx__lcd_hold(bool hold);
+
 /** Set the virtual display to mirror to the screen.
  *
  * @param display_buffer The screen buffer to mirror.
  */
 void nx__lcd_set_display(U8 *display_buffer);
 
+/** Set the buffer row shown at the top of the screen.
+ *
+ * The display buffer is a ring of rows: screen row @a n is mirrored
+ * from buffer row (@a row + @a n) modulo the number of rows. This lets
+ * the display scroll without moving the buffer contents.
+ *
+ * @param row The first row of the ring.
+ */
+void nx__lcd_set_first_row(U32 row);
+
 /** Mark the display as requiring a refresh cycle. */
 void nx__lcd_dirty_display(void);
 
+/** Mark some rows of the display as requiring a refresh cycle.
+ *
+ * Only these rows are mirrored to the screen by the next refresh
+ * cycle (on the DE1-SoC; the NXT always refreshes the whole screen).
+ *
+ * @param rows A bitmap of the rows to refresh: row @a n is bit (@a n %
+ * 32) of word (@a n / 32).
+ */
+void nx__lcd_dirty_rows(const U32 rows[NX__LCD_DIRTY_WORDS]);
+
 /** Safely power off the LCD controller.
  *
  * The LCD controller must be powered off this way in order to drain
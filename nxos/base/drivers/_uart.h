@@ -45,6 +45,16 @@
 #define UART_INTR_WI_MASK 0x0200
 #define UART_INTR_AC_MASK 0x0400
 
+/** @name Ring buffer sizes
+ *
+ * Bytes buffered between the application and the UART FIFOs, which
+ * the interrupt handler moves. Both must be powers of two.
+ */
+/*@{*/
+#define NX__UART_RX_RING_SIZE 512
+#define NX__UART_TX_RING_SIZE 1024
+/*@}*/
+
 /** Initialize the UART driver. */
 void nx__uart_init(void);
 
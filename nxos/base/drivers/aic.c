@@ -19,6 +19,8 @@
 #endif
 
 #include "base/types.h"
+#include "base/assert.h"
+#include "base/interrupts.h"
 #include "base/_interrupts.h"
 #include "base/drivers/_aic.h"
 
@@ -27,78 +29,106 @@
 
 /* Despite the name (AIC), this module is written for the Cortex-A9 GIC
  * The function name remains unchanged due to historical reasons.
+ *
+ * The IRQ dispatcher (interrupts.S) looks handlers up in the vector
+ * table of ivr_table.S, up to the first free entry. Installing a
+ * handler fills a free entry, and sets up the interrupt line in the
+ * GIC distributor.
  */
-	// FIXME
+
+#define GIC_DIST_REG(offset) (*(HW_REG *)(MPCORE_GIC_DIST + (offset)))
+#define GIC_DIST_BYTE(offset) (*(HW_REG8 *)(MPCORE_GIC_DIST + (offset)))
+
+/* One bit per interrupt line in the enable and pending registers. */
+#define LINE_WORD(reg, vector) GIC_DIST_REG((reg) + ((vector) / 32) * 4)
+#define LINE_BIT(vector) (1 << ((vector) % 32))
+
+extern nx__aic_vector_entry_t de1_soc_ivr_table[];
+extern nx__aic_vector_entry_t de1_soc_ivr_table_end[];
 
 /** Initialize the interrupt controller. */
 void nx__aic_init(void) {
-	// FIXME: Setup other peripherals
+	/* The GIC interfaces and the timer line are set up by init.S. */
 }
 
-/** Install @a isr as the handler for @a vector.
- *
- * @param vector The interrupt vector to configure.
- * @param prio The interrupt's priority.
- * @param trig_mode The interrupt's trigger mode.
- * @param isr The routine to call when the interrupt occurs.
- *
- * @note The interrupt line @a vector is enabled once the handler is
- * installed. There is no need to call nx_aic_enable() yourself.
- *
- * @warning If you install an ISR for a peripheral that already has
- * one installed, you @b will replace the original handler. Use with
- * care!
- */
 void nx_aic_install_isr(nx_aic_vector_t vector, nx_aic_priority_t prio,
                         nx_aic_trigger_mode_t trig_mode, nx_closure_t isr) {
-// FIXME: This is not used unless we want to handle ISR for other peripherals
-	UNUSED(vector);
-	UNUSED(prio)
-	UNUSED(trig_mode);
-	UNUSED(isr);
+	nx__aic_vector_entry_t *entry;
+	U32 cfg, shift;
+
+	nx_interrupts_disable();
+	nx_aic_disable(vector);
+	nx_aic_clear(vector);
+
+	/* Replace the handler of the line, or take the first free entry.
+	 * The last entry is the guard, which must stay free.
+	 */
+	for (entry = de1_soc_ivr_table; entry < de1_soc_ivr_table_end - 1; entry++) {
+		if (entry->id == vector || entry->id == NX__AIC_INVALID_ID)
+			break;
+	}
+	NX_ASSERT_MSG(entry < de1_soc_ivr_table_end - 1, "IVR table full");
+	if (entry->id == NX__AIC_INVALID_ID) {
+		/* The first free entry counts the unknown interrupts: hand
+		 * that count over to the next one.
+		 */
+		entry[1].count += entry->count;
+		entry->count = 0;
+	}
+	entry->isr = isr;
+	entry->id = vector;
+
+	/* Lower values are more urgent for the GIC. */
+	GIC_DIST_BYTE(ICDIPR + vector) = (AIC_PRIO_TICK - prio) << 5;
+	GIC_DIST_BYTE(ICDIPTR + vector) = 0x01;		/* Target CPU0 */
+
+	shift = (vector % 16) * 2 + 1;
+	cfg = GIC_DIST_REG(ICDICFR + (vector / 16) * 4) & ~(1 << shift);
+	if (trig_mode == AIC_TRIG_EDGE)
+		cfg |= 1 << shift;
+	GIC_DIST_REG(ICDICFR + (vector / 16) * 4) = cfg;
+
+	nx_aic_enable(vector);
+	nx_interrupts_enable();
+}
+
+/* The entry that ends the lookup of the dispatcher. */
+static nx__aic_vector_entry_t *first_free(void) {
+	nx__aic_vector_entry_t *entry = de1_soc_ivr_table;
 
+	while (entry->id != NX__AIC_INVALID_ID)
+		entry++;
+	return entry;
 }
 
-/** Enable dispatching of @a vector.
- *
- * @param vector The interrupt vector to enable.
- */
-void nx_aic_enable(nx_aic_vector_t vector) {
-	// FIXME: This is not used unless we want to handle ISR for other peripherals
-	UNUSED(vector);
+bool nx_aic_get_count(U32 index, nx_aic_vector_t *vector, U32 *count) {
+	nx__aic_vector_entry_t *entry = &de1_soc_ivr_table[index];
 
+	if (entry >= first_free())
+		return FALSE;
+	*vector = entry->id;
+	*count = entry->count;
+	return TRUE;
 }
 
-/** Disable dispatching of @a vector.
- *
- * @param vector The interrupt vector to disable.
- */
-void nx_aic_disable(nx_aic_vector_t vector) {
-	// FIXME: This is not used unless we want to handle ISR for other peripherals
-	UNUSED(vector);
+U32 nx_aic_get_spurious_count(void) {
+	return first_free()->count;
+}
 
+void nx_aic_enable(nx_aic_vector_t vector) {
+	LINE_WORD(ICDISER, vector) = LINE_BIT(vector);
+}
+
+void nx_aic_disable(nx_aic_vector_t vector) {
+	LINE_WORD(ICDICER, vector) = LINE_BIT(vector);
 }
 
-/** Manually trigger the interrupt line @a vector.
- *
- * @param vector The interrupt vector to trigger.
- */
 void nx_aic_set(nx_aic_vector_t vector) {
-	// FIXME: This is not used unless we want to handle ISR for other peripherals
-	UNUSED(vector);
+	LINE_WORD(ICDISPR, vector) = LINE_BIT(vector);
 }
 
-/** Manually reset the interrupt line @a vector.
- *
- * @param vector The interrupt vector to reset.
- *
- * @note This should only be needed in the cases where the interrupt
- * line was triggered manually with nx_aic_set(). In other cases, each
- * peripheral has its own discipline for acknowledging the interrupt.
- */
 void nx_aic_clear(nx_aic_vector_t vector) {
-	// FIXME: This is not used unless we want to handle ISR for other peripherals
-	UNUSED(vector);
+	LINE_WORD(ICDICPR, vector) = LINE_BIT(vector);
 }
 
 #endif
@@ -101,6 +101,20 @@ void nx_aic_set(nx_aic_vector_t vector);
  */
 void nx_aic_clear(nx_aic_vector_t vector);
 
+#ifdef __DE1SOC__
+/** Get the number of interrupts dispatched to an installed handler.
+ *
+ * @param index The index of the handler, from 0.
+ * @param vector Where to store the interrupt vector of the handler.
+ * @param count Where to store the number of dispatches since boot.
+ * @return FALSE if there are fewer than @a index + 1 handlers.
+ */
+bool nx_aic_get_count(U32 index, nx_aic_vector_t *vector, U32 *count);
+
+/** Return the number of interrupts that had no handler. */
+U32 nx_aic_get_spurious_count(void);
+#endif
+
 /*@}*/
 /*@}*/
 
@@ -21,26 +21,54 @@
 
 #include "base/drivers/_button.h"
 
+#define KEY_REG(index) (((HW_REG *) KEY_BASE)[index])
+
+/* Presses taken from the edge capture register but not returned yet. */
+static U32 pending_events;
+
+/* Map a button mask to its highest numbered button. */
+static nx_de1_button_t mask_to_button(U32 mask) {
+  if (mask & BUTTON_3_MASK)
+    return BUTTON_3;
+  else if (mask & BUTTON_2_MASK)
+    return BUTTON_2;
+  else if (mask & BUTTON_1_MASK)
+    return BUTTON_1;
+  else if (mask & BUTTON_0_MASK)
+    return BUTTON_0;
+  else
+    return BUTTON_NONE;
+}
+
 void nx_de1_button_init(void) {
-  // FIXME: Do nothing as we're not going to enable interrupts
+  nx_de1_button_clear_events();
 }
 
 nx_de1_button_t nx_de1_get_button(void) {
+  return mask_to_button(KEY_REG(BUTTON_DATA_INDEX) & BUTTON_ALLMASK);
+}
 
-  HW_REG *buttonreg = (HW_REG *) KEY_BASE;
+nx_de1_button_t nx_de1_get_button_event(void) {
+  U32 edges = KEY_REG(BUTTON_EDGECAPTURE_INDEX) & BUTTON_ALLMASK;
+  nx_de1_button_t button;
 
-  int buttonInput = (*buttonreg & BUTTON_ALLMASK);
-  if (buttonInput & BUTTON_3_MASK)
-	return BUTTON_3;
-  else if (buttonInput & BUTTON_2_MASK)
-	return BUTTON_2;
-  else if (buttonInput & BUTTON_1_MASK)
-    return BUTTON_1;
-  else if (buttonInput & BUTTON_0_MASK)
-	return BUTTON_0;
-  else
-  	return BUTTON_NONE;
+  /* Writing back the bits read clears exactly those, without losing a
+   * press latched in between.
+   */
+  if (edges) {
+    KEY_REG(BUTTON_EDGECAPTURE_INDEX) = edges;
+    pending_events |= edges;
+  }
+
+  button = mask_to_button(pending_events);
+  if (button != BUTTON_NONE)
+    pending_events &= ~(BUTTON_0_MASK << (button - BUTTON_0));
+  return button;
+}
 
+void nx_de1_button_clear_events(void) {
+  KEY_REG(BUTTON_EDGECAPTURE_INDEX) = BUTTON_ALLMASK;
+  pending_events = 0;
 }
 
 #endif /* __DE1SOC__ */
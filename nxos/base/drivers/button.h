@@ -26,8 +26,12 @@
  * This is meant for the Altera DE1-SoC board implemneted by CPUlator. It does not support
  * LEGO_NXT buttons.
  *
- * @warning Currently the button driver retrieves the status of the button when called.
- * It does not handle debouncing or other hardware issues.
+ * nx_de1_get_button() returns the current state of the buttons, and
+ * nx_de1_get_button_event() the presses latched by the edge capture
+ * register of the KEY port. Events are not lost between two polls, and
+ * a button held down is reported only once.
+ *
+ * @warning The driver polls the KEY port: it does not use interrupts.
  */
 /*@{*/
 
@@ -50,6 +54,24 @@ typedef enum {
  */
 nx_de1_button_t nx_de1_get_button(void);
 
+/** Return the next button press event.
+ *
+ * Each press of a button is returned once. If several buttons were
+ * pressed since the last call, the highest numbered one is returned
+ * first, and the others by the next calls.
+ *
+ * @return The button pressed, or <tt>BUTTON_NONE</tt> if there is no
+ * pending event.
+ */
+nx_de1_button_t nx_de1_get_button_event(void);
+
+/** Discard the pending button press events.
+ *
+ * Call this before waiting for a new press, so that a press handled by
+ * a previous screen is not reported again.
+ */
+void nx_de1_button_clear_events(void);
+
 /*@}*/
 /*@}*/
 
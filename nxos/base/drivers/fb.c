@@ -0,0 +1,69 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifdef __DE1SOC__
+#include "base/boards/DE1-SoC/address_map_arm.h"
+#endif
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/assert.h"
+#include "base/drivers/systick.h"
+
+#ifdef __DE1SOC__
+
+#include "base/drivers/_fb.h"
+
+#define FB_REG(index) (((HW_REG *) PIXEL_BUF_CTRL_BASE)[index])
+
+void nx_fb_init(void) {
+  NX_ASSERT(FB_REG(NX__FB_RES_INDEX) ==
+            ((NX_FB_HEIGHT << 16) | NX_FB_WIDTH));
+
+  memset((void *)NX__FB_BUFFER0, 0, NX__FB_SIZE);
+  memset((void *)NX__FB_BUFFER1, 0, NX__FB_SIZE);
+
+  /* Any previous swap must be over before the back buffer register
+   * can be changed. Then show buffer 0, and draw into buffer 1.
+   */
+  nx_fb_swap_wait();
+  FB_REG(NX__FB_BACK_INDEX) = NX__FB_BUFFER0;
+  nx_fb_swap();
+  FB_REG(NX__FB_BACK_INDEX) = NX__FB_BUFFER1;
+}
+
+U16 *nx_fb_get_back_buffer(void) {
+  return (U16 *)FB_REG(NX__FB_BACK_INDEX);
+}
+
+U16 *nx_fb_get_front_buffer(void) {
+  return (U16 *)FB_REG(NX__FB_FRONT_INDEX);
+}
+
+bool nx_fb_swap_pending(void) {
+  return (FB_REG(NX__FB_STATUS_INDEX) & NX__FB_STATUS_SWAP) ? TRUE : FALSE;
+}
+
+void nx_fb_swap_start(void) {
+  /* Writing the front buffer register makes the controller exchange
+   * both addresses at the next vertical sync.
+   */
+  FB_REG(NX__FB_FRONT_INDEX) = 1;
+}
+
+void nx_fb_swap_wait(void) {
+  while (nx_fb_swap_pending())
+    nx_systick_idle();
+}
+
+void nx_fb_swap(void) {
+  nx_fb_swap_start();
+  nx_fb_swap_wait();
+}
+
+#endif /* __DE1SOC__ */
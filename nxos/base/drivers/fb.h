@@ -0,0 +1,101 @@
+/** @file fb.h
+ *  @brief Pixel framebuffer interface.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_DRIVERS_FB_H__
+#define __NXOS_BASE_DRIVERS_FB_H__
+
+#include "base/types.h"
+
+#ifdef __DE1SOC__
+
+/** @addtogroup driver */
+/*@{*/
+
+/** @defgroup fb Pixel framebuffer
+ *
+ * The pixel framebuffer driver drives the DE1-SoC VGA pixel buffer
+ * controller with two frame buffers in the FPGA SDRAM: the front
+ * buffer is being displayed, while the application draws the next
+ * frame into the back buffer. nx_fb_swap() then exchanges them at the
+ * next vertical sync, so that frames are shown whole and never copied.
+ *
+ * Pixels are 16-bit RGB565. A line is NX_FB_STRIDE pixels apart from
+ * the next one in memory, of which the first NX_FB_WIDTH are visible.
+ *
+ * The character buffer of the text display is overlaid on top of the
+ * pixels.
+ *
+ * @note The FPGA SDRAM is mapped uncached, so the buffers need no
+ * cache maintenance before a swap.
+ */
+/*@{*/
+
+#define NX_FB_WIDTH 320 /**< Visible width, in pixels. */
+#define NX_FB_HEIGHT 240 /**< Visible height, in pixels. */
+#define NX_FB_STRIDE 512 /**< Distance between two lines, in pixels. */
+
+/** Build an RGB565 pixel from 8-bit red, green and blue components. */
+#define NX_FB_RGB(r, g, b) \
+  ((U16)((((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | (((b) & 0xF8) >> 3)))
+
+/** Initialize the framebuffer.
+ *
+ * Both buffers are cleared to black and the first one is displayed.
+ * This must be called before any other framebuffer function.
+ */
+void nx_fb_init(void);
+
+/** Return the back buffer, which is drawn into.
+ *
+ * @return The address of the top-left pixel of the back buffer.
+ */
+U16 *nx_fb_get_back_buffer(void);
+
+/** Return the front buffer, which is being displayed.
+ *
+ * @return The address of the top-left pixel of the front buffer.
+ */
+U16 *nx_fb_get_front_buffer(void);
+
+/** Display the back buffer.
+ *
+ * The buffers are exchanged at the next vertical sync. This waits
+ * for the exchange to happen, so that on return the new back buffer
+ * (the previous front buffer) is no longer displayed and can be drawn
+ * into.
+ */
+void nx_fb_swap(void);
+
+/** Request a swap of the buffers, without waiting for it.
+ *
+ * Neither buffer may be drawn into until nx_fb_swap_wait() returns.
+ */
+void nx_fb_swap_start(void);
+
+/** Wait for a swap requested by nx_fb_swap_start() to complete.
+ *
+ * The waiting time is spent in nx_systick_idle(), which refreshes the
+ * text display and runs the idle callbacks.
+ */
+void nx_fb_swap_wait(void);
+
+/** Check whether a buffer swap is still pending.
+ *
+ * @return TRUE until the requested swap has happened.
+ */
+bool nx_fb_swap_pending(void);
+
+/*@}*/
+/*@}*/
+
+#endif /* __DE1SOC__ */
+#endif /* __NXOS_BASE_DRIVERS_FB_H__ */
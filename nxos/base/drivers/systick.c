@@ -33,9 +33,11 @@
 #endif
 
 #include "base/types.h"
+#include "base/memmap.h"
 #include "base/interrupts.h"
 #include "base/drivers/aic.h"
 #include "base/drivers/_lcd.h"
+#include "base/_stack.h"
 
 #include "base/drivers/_systick.h"
 #include "base/drivers/_systick_def.h"
@@ -43,7 +45,7 @@
 /* The system timer. Counts the number of milliseconds elapsed since
  * the system's initialization.
  */
-static volatile U32 systick_time;
+static volatile U32 systick_time NX_FAST_DATA;
 
 /* The scheduler callback. Application kernels can set this to their own
  * callback function, to do scheduling in the high priority systick
@@ -56,6 +58,10 @@ static nx_closure_t scheduler_cb = NULL;
  */
 static bool scheduler_inhibit = FALSE;
 
+/* The idle callbacks, and whether they are running. */
+static nx_closure_t idle_cbs[NX_SYSTICK_IDLE_MAX];
+static bool idle_running = FALSE;
+
 #ifdef __LEGONXT__
 /* Low priority handler, called 1000 times a second by the high
  * priority handler if a scheduler callback is registered.
@@ -71,7 +77,7 @@ static void systick_sched(void) {
 #endif
 
 /* High priority handler, called 1000 times a second */
-void systick_isr(void) {
+NX_FAST void systick_isr(void) {
 
 #ifdef __DE1SOC__
   ((HW_REG *) MPCORE_PRIV_TIMER)[MPT_INTSTAT_INDEX] = PTINTR_ACK;		// Acknowledge Interrupt
@@ -98,11 +104,14 @@ void systick_isr(void) {
    * As a result, this handler must be *very* fast.
    */
 
-  /* The LCD dirty display routine can be done here too, since it is
-   * very short.
+  /* The LCD refresh is normally done from idle context, this only
+   * kicks it when that has not run for a while.
    */
   nx__lcd_fast_update();
 
+  /* Periodic stack guard band check, if enabled. */
+  nx__stack_check();
+
   if (!scheduler_inhibit)
     nx_systick_call_scheduler();
 }
@@ -151,6 +160,30 @@ U32 nx_systick_get_ms(void) {
   return systick_time;
 }
 
+U32 nx_systick_get_cycles(void) {
+  U32 ms, count, period;
+
+#ifdef __DE1SOC__
+  /* The private timer counts down from its load value to 0. */
+  period = ((HW_REG *) MPCORE_PRIV_TIMER)[MPT_LOAD_INDEX] + 1;
+  do {
+    ms = systick_time;
+    count = period - 1 - ((HW_REG *) MPCORE_PRIV_TIMER)[MPT_COUNTER_INDEX];
+  } while (ms != systick_time);
+#endif
+
+#ifdef __LEGONXT__
+  /* The PIT counts up from 0 to its period. */
+  period = (*AT91C_PITC_PIMR & AT91C_PITC_PIV) + 1;
+  do {
+    ms = systick_time;
+    count = *AT91C_PITC_PIIR & AT91C_PITC_CPIV;
+  } while (ms != systick_time);
+#endif
+
+  return ms * period + count;
+}
+
 void nx_systick_wait_ms(U32 ms) {
   U32 final = systick_time + ms;
 
@@ -162,7 +195,9 @@ void nx_systick_wait_ms(U32 ms) {
 #if 0
   while (systick_time < final);
 #else
-  while ((long) (systick_time - final) < 0);
+  /* Waiting is idle time: use it to refresh the display. */
+  while ((long) (systick_time - final) < 0)
+    nx_systick_idle();
 #endif
 
 }
@@ -216,6 +251,48 @@ void nx_systick_call_scheduler(void) {
 #endif
 }
 
+bool nx_systick_install_idle(nx_closure_t cb) {
+  U32 i, free = NX_SYSTICK_IDLE_MAX;
+
+  for (i = 0; i < NX_SYSTICK_IDLE_MAX; i++) {
+    if (idle_cbs[i] == cb)
+      return TRUE;
+    if (idle_cbs[i] == NULL && free == NX_SYSTICK_IDLE_MAX)
+      free = i;
+  }
+  if (free == NX_SYSTICK_IDLE_MAX)
+    return FALSE;
+
+  idle_cbs[free] = cb;
+  return TRUE;
+}
+
+void nx_systick_remove_idle(nx_closure_t cb) {
+  U32 i;
+
+  for (i = 0; i < NX_SYSTICK_IDLE_MAX; i++) {
+    if (idle_cbs[i] == cb)
+      idle_cbs[i] = NULL;
+  }
+}
+
+void nx_systick_idle(void) {
+  U32 i;
+
+  nx__lcd_flush();
+
+  /* The callbacks may wait in turn: do not nest them. */
+  if (idle_running)
+    return;
+
+  idle_running = TRUE;
+  for (i = 0; i < NX_SYSTICK_IDLE_MAX; i++) {
+    if (idle_cbs[i])
+      idle_cbs[i]();
+  }
+  idle_running = FALSE;
+}
+
 void nx_systick_mask_scheduler(void) {
   scheduler_inhibit = TRUE;
 }
@@ -35,6 +35,17 @@ void systick_isr(void);
 /** Return the number of milliseconds elapsed since bootup. */
 U32 nx_systick_get_ms(void);
 
+/** Return a free running count of system timer clock cycles.
+ *
+ * This combines the millisecond counter with the current value of the
+ * system timer, and is meant for short duration measurements such as
+ * benchmarks. The counter wraps around every few seconds (about 21 s on
+ * the DE1-SoC at 200 MHz), so only differences are meaningful.
+ *
+ * @note The result is only monotonic while interrupts are enabled.
+ */
+U32 nx_systick_get_cycles(void);
+
 /** Sleep for @a ms milliseconds.
  *
  * @param ms The number of milliseconds to sleep.
@@ -88,6 +99,34 @@ void nx_systick_install_scheduler(nx_closure_t scheduler_cb);
  */
 void nx_systick_call_scheduler(void);
 
+/** Maximum number of idle callbacks. */
+#define NX_SYSTICK_IDLE_MAX 4
+
+/** Add @a idle_cb to the idle callbacks.
+ *
+ * The idle callbacks run from nx_systick_idle(), in the context of the
+ * application, for background work such as draining logs. They should
+ * return quickly.
+ *
+ * @param idle_cb The idle callback to add. Adding it again does nothing.
+ * @return FALSE if there are already @c NX_SYSTICK_IDLE_MAX callbacks.
+ */
+bool nx_systick_install_idle(nx_closure_t idle_cb);
+
+/** Remove @a idle_cb from the idle callbacks.
+ *
+ * @param idle_cb The idle callback to remove.
+ */
+void nx_systick_remove_idle(nx_closure_t idle_cb);
+
+/** Do the background work of idle time.
+ *
+ * This refreshes the display and runs the idle callbacks. The kernel
+ * calls it while waiting in nx_systick_wait_ms(); applications that
+ * busy loop otherwise should call it from their loop.
+ */
+void nx_systick_idle(void);
+
 /** Inhibit the scheduler callback temporarily.
  *
  * This will simply prevent the systick driver from calling the
@@ -11,81 +11,325 @@
 #include "base/boards/DE1-SoC/interrupt_ID.h"
 #endif
 
+#include <stdarg.h>
+
 #include "base/types.h"
+#include "base/memmap.h"
+#include "base/util.h"
 #include "base/assert.h"
+#include "base/format.h"
 #include "base/interrupts.h"
 #include "base/drivers/aic.h"
 #include "base/drivers/systick.h"
 
 #include "base/drivers/_uart.h"
 
-static volatile struct {
-  U32 num_read;
-  U8 readbuf[UART_RXBUFSIZE]; 		/* Used for interrupt driven reads */
+#ifdef __DE1SOC__
+
+#define UART_REG(u, index) (((HW_REG *)(u)->base)[index])
+#define UART_WDATA(u) (((HW_REG8 *)(u)->base)[UART_WDATA_BYTE_INDEX])
+
+#define RX_MASK (NX__UART_RX_RING_SIZE - 1)
+#define TX_MASK (NX__UART_TX_RING_SIZE - 1)
+
+/* The indices run freely: the fill level is head - tail. The receive
+ * ring is filled with interrupts masked and emptied by the
+ * application, the transmit ring the other way round.
+ */
+typedef volatile struct {
+	U32 base;
+
+	U8 rx[NX__UART_RX_RING_SIZE];
+	U8 tx[NX__UART_TX_RING_SIZE];
+	U32 rx_head, rx_tail;
+	U32 tx_head, tx_tail;
+
+	nx_uart_stats_t stats;
+
+	/* Interrupt enables last written to the control register. */
+	U32 control;
+} uart_t;
 
-} uart_state = {
-  0, {0}
+static uart_t uarts[NX_UART_PORTS];
+
+static const U32 uart_bases[NX_UART_PORTS] = {
+	JTAG_UART_BASE,
+	JTAG_UART_2_BASE,
 };
 
-#ifdef __DE1SOC__
-	// FIXME
-#define UNUSED(x) (void)(x)
+static inline void set_control(uart_t *u, U32 control) {
+	if (control != u->control) {
+		u->control = control;
+		UART_REG(u, UART_CONTROL_INDEX) = control;
+		u->stats.mmio_writes++;
+	}
+}
+
+/* Read the free space of the transmit FIFO. */
+static inline U32 fifo_space(uart_t *u) {
+	u->stats.mmio_reads++;
+	return UART_REG(u, UART_CONTROL_INDEX) >> WSPACE_SHIFT;
+}
+
+/* Drain the receive FIFO into the receive ring. Each read of the data
+ * register pops one byte, flagged valid if the FIFO was not empty.
+ */
+static NX_FAST void rx_drain(uart_t *u) {
+	U32 head = u->rx_head, reads = 1;
+	U32 data;
+
+	while ((data = UART_REG(u, UART_DATA_INDEX)) & RVALID_MASK) {
+		reads++;
+		if (head - u->rx_tail < NX__UART_RX_RING_SIZE)
+			u->rx[head++ & RX_MASK] = data & UART_DATAREG_MASK;
+		else
+			u->stats.rx_overruns++;
+	}
+	u->stats.rx_bytes += head - u->rx_head;
+	u->stats.mmio_reads += reads;
+	u->rx_head = head;
+}
+
+/* Fill the transmit FIFO from the transmit ring, reading the free
+ * space once. The write interrupt stays enabled while bytes remain.
+ */
+static NX_FAST void tx_fill(uart_t *u) {
+	U32 tail = u->tx_tail, head = u->tx_head;
+	U32 n;
+
+	if (tail != head) {
+		n = MIN(fifo_space(u), head - tail);
+		u->stats.mmio_writes += n;
+		while (n-- > 0)
+			UART_WDATA(u) = u->tx[tail++ & TX_MASK];
+		u->tx_tail = tail;
+	}
 
-/** Initialize the UART driver.
+	if (tail == head)
+		set_control(u, u->control & ~UART_INTR_WE_MASK);
+	else
+		set_control(u, u->control | UART_INTR_WE_MASK);
+}
+
+/* Only the first port has a line in the board's interrupt map: its
+ * handler serves both ports, and the second also progresses whenever
+ * the application uses it.
+ */
+static NX_FAST void uart_isr(void) {
+	U32 i;
+
+	for (i = 0; i < NX_UART_PORTS; i++) {
+		rx_drain(&uarts[i]);
+		tx_fill(&uarts[i]);
+	}
+}
+
+/* Move bytes from the application side, so that the rings make
+ * progress even when interrupts are disabled.
+ */
+static void uart_pump(uart_t *u) {
+	nx_interrupts_disable();
+	rx_drain(u);
+	tx_fill(u);
+	nx_interrupts_enable();
+}
+
+/* Send or queue up to length bytes, and return how many. Must be
+ * called with interrupts masked.
  *
- * @param callback The callback to fire when the UART receives data.
+ * While nothing is queued, bytes go straight to the FIFO in a burst
+ * sized by a single read of its free space; only the rest is copied
+ * to the ring, for the interrupt handler.
  */
+static U32 tx_write(uart_t *u, const U8 *buf, U32 length) {
+	U32 head = u->tx_head, count = 0, n;
+
+	if (head == u->tx_tail) {
+		n = MIN(fifo_space(u), length);
+		u->stats.mmio_writes += n;
+		count = n;
+		while (n-- > 0)
+			UART_WDATA(u) = *buf++;
+		length -= count;
+	}
+
+	if (length > 0) {
+		n = MIN(length, NX__UART_TX_RING_SIZE - (head - u->tx_tail));
+		count += n;
+		while (n-- > 0)
+			u->tx[head++ & TX_MASK] = *buf++;
+		u->tx_head = head;
+		set_control(u, u->control | UART_INTR_WE_MASK);
+	}
+
+	u->stats.tx_bytes += count;
+	return count;
+}
+
+/** Initialize the UART driver. */
 void nx__uart_init(void) {
-	nx_uart_readbuf((U8 *)&uart_state.readbuf, (U32 *)&uart_state.num_read);		// Clear UART read buffer
-	uart_state.num_read = 0;
+	uart_t *u;
+	U32 i;
+
+	for (i = 0; i < NX_UART_PORTS; i++) {
+		u = &uarts[i];
+		u->base = uart_bases[i];
+
+		/* Discard what was received before boot. */
+		while (UART_REG(u, UART_DATA_INDEX) & RVALID_MASK);
+
+		u->rx_head = u->rx_tail = 0;
+		u->tx_head = u->tx_tail = 0;
+		memset((void *)&u->stats, 0, sizeof(u->stats));
+		u->control = UART_INTR_RE_MASK;
+		UART_REG(u, UART_CONTROL_INDEX) = u->control;
+	}
+
+	nx_aic_install_isr(JTAG_IRQ, AIC_PRIO_DRIVER, AIC_TRIG_LEVEL, uart_isr);
 }
+
+U32 nx_uart_port_read_avail(nx_uart_port_t port) {
+	uart_t *u = &uarts[port];
+
+	uart_pump(u);
+	return u->rx_head - u->rx_tail;
+}
+
+U32 nx_uart_port_write_avail(nx_uart_port_t port) {
+	uart_t *u = &uarts[port];
+
+	uart_pump(u);
+	return NX__UART_TX_RING_SIZE - (u->tx_head - u->tx_tail);
+}
+
+U32 nx_uart_port_read(nx_uart_port_t port, U8 *buf, U32 length) {
+	uart_t *u = &uarts[port];
+	U32 tail, count;
+
+	uart_pump(u);
+	tail = u->rx_tail;
+	count = MIN(length, u->rx_head - tail);
+	length = count;
+	while (length-- > 0)
+		*buf++ = u->rx[tail++ & RX_MASK];
+	u->rx_tail = tail;
+
+	return count;
+}
+
+U32 nx_uart_port_write(nx_uart_port_t port, const U8 *buf, U32 length) {
+	uart_t *u = &uarts[port];
+	U32 count;
+
+	nx_interrupts_disable();
+	count = tx_write(u, buf, length);
+	u->stats.tx_overruns += length - count;
+	nx_interrupts_enable();
+
+	return count;
+}
+
+void nx_uart_port_writev(nx_uart_port_t port, const nx_uart_iovec_t *iov,
+                         U32 count) {
+	uart_t *u = &uarts[port];
+	const U8 *buf;
+	U32 length, n;
+
+	for (; count > 0; iov++, count--) {
+		buf = iov->buf;
+		length = iov->len;
+
+		while (length > 0) {
+			nx_interrupts_disable();
+			n = tx_write(u, buf, length);
+			nx_interrupts_enable();
+			buf += n;
+			length -= n;
+
+			/* The ring is full: wait for the FIFO to drain. */
+			if (length > 0)
+				uart_pump(u);
+		}
+	}
+}
+
+void nx_uart_port_writebuf(nx_uart_port_t port, const U8 *buf, U32 length) {
+	nx_uart_iovec_t iov = { buf, length };
+
+	nx_uart_port_writev(port, &iov, 1);
+}
+
+void nx_uart_port_get_stats(nx_uart_port_t port, nx_uart_stats_t *stats) {
+	nx_interrupts_disable();
+	memcpy(stats, (const void *)&uarts[port].stats, sizeof(*stats));
+	nx_interrupts_enable();
+}
+
+void nx_uart_port_reset_stats(nx_uart_port_t port) {
+	nx_interrupts_disable();
+	memset((void *)&uarts[port].stats, 0, sizeof(uarts[port].stats));
+	nx_interrupts_enable();
+}
+
+/* The historical interface drives the first port. */
+
 U32 nx_uart_read_avail(void) {
-	// U32 rdata = ((HW_REG *)JTAG_UART_BASE)[UART_DATA_INDEX];
-	// return (U32) ravail;
-	return (U16) ((HW_REG16 *)JTAG_UART_BASE)[UART_RAVAIL_SHORT_INDEX];
+	return nx_uart_port_read_avail(NX_UART_0);
 }
 
 U32 nx_uart_write_avail(void) {
-	return (U16) ((HW_REG16 *)JTAG_UART_BASE)[UART_WSPACE_SHORT_INDEX];
-	//return (U32) ((((HW_REG *)JTAG_UART_BASE)[UART_CONTROL_INDEX] & WSPACE_MASK) >> WSPACE_SHIFT);
+	return nx_uart_port_write_avail(NX_UART_0);
+}
+
+U32 nx_uart_read(U8 *buf, U32 length) {
+	return nx_uart_port_read(NX_UART_0, buf, length);
+}
+
+U32 nx_uart_write(const U8 *buf, U32 length) {
+	return nx_uart_port_write(NX_UART_0, buf, length);
+}
+
+void nx_uart_writev(const nx_uart_iovec_t *iov, U32 count) {
+	nx_uart_port_writev(NX_UART_0, iov, count);
+}
+
+void nx_uart_get_stats(nx_uart_stats_t *stats) {
+	nx_uart_port_get_stats(NX_UART_0, stats);
+}
+
+void nx_uart_reset_stats(void) {
+	nx_uart_port_reset_stats(NX_UART_0);
 }
 
 U8 nx_uart_getchar(void) {
+	U8 readchar;
 
-	while (nx_uart_read_avail() == 0);
-	U16 rdata = ((HW_REG16 *)JTAG_UART_BASE)[UART_RDATA_SHORT_INDEX];	// Read from FIFO, RAVAIL is decremented
-	if (rdata & RVALID_MASK)
-		return (U8) (rdata & UART_DATAREG_MASK);
-	else
-		return 0;			// return NUL if not valid
+	while (nx_uart_read(&readchar, 1) == 0);
+	return readchar;
 }
 
 void nx_uart_putchar(U8 writechar) {
-
-	while (nx_uart_write_avail() == 0);
-	((HW_REG8 *)JTAG_UART_BASE)[UART_WDATA_BYTE_INDEX] = writechar;
+	nx_uart_writebuf(&writechar, 1);
 }
 
 void nx_uart_readbuf(U8 *buf, U32 *length) {
-
-	int count = nx_uart_read_avail();
-	*length = count;
-	while (count > 0) {
-		*buf = nx_uart_getchar();			// This is ok since it is a blocking call
-		buf++;
-		count--;
-	}
+	*length = nx_uart_read(buf, UART_RXBUFSIZE);
 }
 
 void nx_uart_writebuf(const U8 *buf, U32 length) {
+	nx_uart_port_writebuf(NX_UART_0, buf, length);
+}
 
-	// U32 availspace = nx_uart_write_avail();
-	while (length > 0) {
-		nx_uart_putchar(*buf);			// This is ok since it is a blocking call
-		buf++;
-		length--;
-	}
+void nx_uart_printf(const char *fmt, ...) {
+	char buf[NX_PRINTF_BUFSIZE];
+	va_list ap;
+	U32 len;
+
+	va_start(ap, fmt);
+	len = nx_vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
 
+	nx_uart_writebuf((const U8 *)buf, MIN(len, sizeof(buf) - 1));
 }
 #endif
 
@@ -23,6 +23,24 @@
 /** @defgroup uart UART driver
  *
  * The UART controller is a serial interface for bidirectional communications.
+ *
+ * The driver is interrupt driven: received bytes are drained from the
+ * hardware FIFO into a receive ring, and bytes written are queued in a
+ * transmit ring that the interrupt handler feeds to the FIFO. Only
+ * the blocking routines wait, and only when the rings are empty or
+ * full.
+ *
+ * Writes check the free space of the transmit FIFO once, and fill it
+ * in a single burst. While the transmit ring is empty, they write to
+ * the FIFO directly, without going through the ring.
+ *
+ * Received bytes that do not fit in the receive ring are dropped, and
+ * counted as overruns.
+ *
+ * The board has two JTAG UARTs. The nx_uart_port_*() routines take the
+ * port to use; the others use the first one, @c NX_UART_0.
+ *
+ * @note These routines must not be called from interrupt handlers.
  */
 /*@{*/
 
@@ -35,16 +53,69 @@
 
 /** Check if the UART can be read from.
  *
- * Indicates how many bytes the UART has available to read
+ * Indicates how many received bytes are available to read
  */
 U32 nx_uart_read_avail(void);
 
 /** Check if the UART can be written to.
  *
- * Indicates how many bytes the UART has available to write
+ * Indicates how many bytes can be written without blocking
  */
 U32 nx_uart_write_avail(void);
 
+/** The UART ports. */
+typedef enum {
+  NX_UART_0 = 0, /**< JTAG UART, the console. */
+  NX_UART_1,     /**< Second JTAG UART. */
+  NX_UART_PORTS, /**< Number of ports. */
+} nx_uart_port_t;
+
+/** @brief A segment of a scatter-gather write. */
+typedef struct {
+  const void *buf; /**< Start of the segment. */
+  U32 len;         /**< Length of the segment in bytes. */
+} nx_uart_iovec_t;
+
+/** Read up to @a length received bytes into @a buf.
+ *
+ * This routine is non-blocking.
+ *
+ * @param buf The buffer to fill.
+ * @param length The size of @a buf.
+ * @return The number of bytes read, possibly 0.
+ */
+U32 nx_uart_read(U8 *buf, U32 length);
+
+/** Queue up to @a length bytes of @a buf for sending.
+ *
+ * This routine is non-blocking: the bytes that do not fit in the
+ * transmit ring are not written, and are counted as transmit overruns.
+ *
+ * @param buf The bytes to send.
+ * @param length The number of bytes to send.
+ * @return The number of bytes queued.
+ */
+U32 nx_uart_write(const U8 *buf, U32 length);
+
+/** @brief UART traffic statistics. */
+typedef struct {
+  U32 rx_bytes;    /**< Bytes received. */
+  U32 tx_bytes;    /**< Bytes sent or queued for sending. */
+  U32 rx_overruns; /**< Received bytes dropped, the receive ring being full. */
+  U32 tx_overruns; /**< Bytes nx_uart_write() could not queue. */
+  U32 mmio_reads;  /**< UART register reads. */
+  U32 mmio_writes; /**< UART register writes. */
+} nx_uart_stats_t;
+
+/** Get the traffic statistics since boot or the last reset.
+ *
+ * @param stats The structure to fill.
+ */
+void nx_uart_get_stats(nx_uart_stats_t *stats);
+
+/** Reset the traffic statistics. */
+void nx_uart_reset_stats(void);
+
 /** Get a character from the UART.
  *
  * This routine is blocking, and will not return until a character has been read
@@ -78,15 +149,54 @@ void nx_uart_readbuf(U8 *buf, U32 *length);
  * The space for buf must be allocated by the caller
  *
  * This routine is blocking, and will not return until the entire buf
- * has been written to the FIFO.
- *
- * To avoid excessive blocking the buf length should be <= UART_TXBUFSIZE
+ * has been queued for sending.
  *
  * @param buf A pointer to the buffer to write.
  * @param length The number of bytes to write.
  */
 void nx_uart_writebuf(const U8 *buf, U32 length);
 
+/** Write the @a count segments of @a iov, in order, over the UART bus.
+ *
+ * This sends e.g. a header and a payload without copying them to a
+ * single buffer first. Like nx_uart_writebuf(), this routine blocks
+ * until all the segments are queued for sending.
+ *
+ * @param iov The segments to write.
+ * @param count The number of segments.
+ */
+void nx_uart_writev(const nx_uart_iovec_t *iov, U32 count);
+
+/** Write formatted output over the UART bus.
+ *
+ * See nx_snprintf() for the format. The output, truncated to
+ * NX_PRINTF_BUFSIZE - 1 characters, is formatted first and then
+ * written in a single nx_uart_writebuf() burst.
+ *
+ * This routine is blocking.
+ *
+ * @param fmt The format string.
+ */
+void nx_uart_printf(const char *fmt, ...)
+  __attribute__((format(printf, 1, 2)));
+
+/** @name Port routines
+ *
+ * These work like the routines of the same name without @c port_,
+ * on the UART @a port.
+ */
+/*@{*/
+U32 nx_uart_port_read_avail(nx_uart_port_t port); /**< See nx_uart_read_avail(). */
+U32 nx_uart_port_write_avail(nx_uart_port_t port); /**< See nx_uart_write_avail(). */
+U32 nx_uart_port_read(nx_uart_port_t port, U8 *buf, U32 length); /**< See nx_uart_read(). */
+U32 nx_uart_port_write(nx_uart_port_t port, const U8 *buf, U32 length); /**< See nx_uart_write(). */
+void nx_uart_port_writebuf(nx_uart_port_t port, const U8 *buf, U32 length); /**< See nx_uart_writebuf(). */
+void nx_uart_port_writev(nx_uart_port_t port, const nx_uart_iovec_t *iov,
+                         U32 count); /**< See nx_uart_writev(). */
+void nx_uart_port_get_stats(nx_uart_port_t port, nx_uart_stats_t *stats); /**< See nx_uart_get_stats(). */
+void nx_uart_port_reset_stats(nx_uart_port_t port); /**< See nx_uart_reset_stats(). */
+/*@}*/
+
 /*@}*/
 /*@}*/
 
@@ -0,0 +1,194 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include <stdarg.h>
+
+#include "base/types.h"
+#include "base/format.h"
+
+/* Output position. Characters past the end of the buffer are counted
+ * but dropped.
+ */
+typedef struct {
+  char *buf;
+  U32 size;
+  U32 len;
+} out_t;
+
+static inline void put(out_t *o, char c) {
+  if (o->len + 1 < o->size)
+    o->buf[o->len] = c;
+  o->len++;
+}
+
+static void put_repeat(out_t *o, char c, S32 n) {
+  for (; n > 0; n--)
+    put(o, c);
+}
+
+/* Quotient of a division by 10, as the high word of the product by
+ * 2^35 / 10 rounded up: a single UMULL, exact for all 32-bit values.
+ */
+static inline U32 div10(U32 v) {
+  return (U32)(((unsigned long long)v * 0xCCCCCCCDUL) >> 35);
+}
+
+/* Write the digits of v backwards from end, and return the first one. */
+static char *utoa_dec(U32 v, char *end) {
+  U32 q;
+
+  do {
+    q = div10(v);
+    *--end = (char)('0' + (v - q * 10));
+    v = q;
+  } while (v != 0);
+
+  return end;
+}
+
+static char *utoa_hex(U32 v, char *end, bool upper) {
+  const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+
+  do {
+    *--end = digits[v & 0xF];
+    v >>= 4;
+  } while (v != 0);
+
+  return end;
+}
+
+/* Output a field of len characters from s, padded to width. Zero
+ * padding goes after the sign, if any.
+ */
+static void put_field(out_t *o, const char *s, S32 len, S32 width,
+                      bool left, bool zero, bool has_sign) {
+  S32 pad = width - len;
+
+  if (!left && zero) {
+    if (has_sign) {
+      put(o, *s++);
+      len--;
+    }
+    put_repeat(o, '0', pad);
+  } else if (!left) {
+    put_repeat(o, ' ', pad);
+  }
+
+  while (len-- > 0)
+    put(o, *s++);
+
+  if (left)
+    put_repeat(o, ' ', pad);
+}
+
+U32 nx_vsnprintf(char *buf, U32 size, const char *fmt, va_list ap) {
+  out_t o = { buf, size, 0 };
+  char num[12], *end = &num[sizeof(num)], *s;
+  bool left, zero, neg, is_long;
+  S32 width, len;
+  U32 v;
+
+  for (; *fmt != '\0'; fmt++) {
+    if (*fmt != '%') {
+      put(&o, *fmt);
+      continue;
+    }
+
+    /* Flags, width and length. */
+    left = zero = FALSE;
+    width = 0;
+    for (fmt++; *fmt == '-' || *fmt == '0'; fmt++) {
+      if (*fmt == '-')
+        left = TRUE;
+      else
+        zero = TRUE;
+    }
+    if (*fmt == '*') {
+      width = va_arg(ap, int);
+      if (width < 0) {
+        left = TRUE;
+        width = -width;
+      }
+      fmt++;
+    } else {
+      for (; *fmt >= '0' && *fmt <= '9'; fmt++)
+        width = width * 10 + (*fmt - '0');
+    }
+    is_long = (*fmt == 'l') ? TRUE : FALSE;
+    if (is_long)
+      fmt++;
+
+    switch (*fmt) {
+    case 'd':
+    case 'i':
+      v = is_long ? (U32)va_arg(ap, long) : (U32)va_arg(ap, int);
+      neg = ((S32)v < 0) ? TRUE : FALSE;
+      s = utoa_dec(neg ? -v : v, end);
+      if (neg)
+        *--s = '-';
+      put_field(&o, s, end - s, width, left, zero, neg);
+      break;
+    case 'u':
+      v = is_long ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int);
+      s = utoa_dec(v, end);
+      put_field(&o, s, end - s, width, left, zero, FALSE);
+      break;
+    case 'x':
+    case 'X':
+      v = is_long ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int);
+      s = utoa_hex(v, end, *fmt == 'X');
+      put_field(&o, s, end - s, width, left, zero, FALSE);
+      break;
+    case 'p':
+      put(&o, '0');
+      put(&o, 'x');
+      s = utoa_hex((U32)va_arg(ap, void *), end, FALSE);
+      put_field(&o, s, end - s, 8, FALSE, TRUE, FALSE);
+      break;
+    case 'c':
+      num[0] = (char)va_arg(ap, int);
+      put_field(&o, num, 1, width, left, FALSE, FALSE);
+      break;
+    case 's':
+      s = va_arg(ap, char *);
+      if (s == NULL)
+        s = "(null)";
+      for (len = 0; s[len] != '\0'; len++);
+      put_field(&o, s, len, width, left, FALSE, FALSE);
+      break;
+    case '%':
+      put(&o, '%');
+      break;
+    case '\0':
+      /* A lone % at the end of the format. */
+      fmt--;
+      put(&o, '%');
+      break;
+    default:
+      put(&o, '%');
+      put(&o, *fmt);
+      break;
+    }
+  }
+
+  if (size > 0)
+    buf[o.len < size ? o.len : size - 1] = '\0';
+
+  return o.len;
+}
+
+U32 nx_snprintf(char *buf, U32 size, const char *fmt, ...) {
+  va_list ap;
+  U32 len;
+
+  va_start(ap, fmt);
+  len = nx_vsnprintf(buf, size, fmt, ap);
+  va_end(ap);
+
+  return len;
+}
@@ -0,0 +1,72 @@
+/** @file format.h
+ *  @brief Formatted output to memory.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_FORMAT_H__
+#define __NXOS_BASE_FORMAT_H__
+
+#include <stdarg.h>
+
+#include "base/types.h"
+
+/** @addtogroup typesAndUtils */
+/*@{*/
+
+/** @defgroup format Formatted output
+ *
+ * A small printf-style formatting engine. The supported directives
+ * are:
+ *
+ * - @c %%d, @c %%i: signed decimal.
+ * - @c %%u: unsigned decimal.
+ * - @c %%x, @c %%X: unsigned hexadecimal, in lower or upper case.
+ * - @c %%p: pointer, as @c 0x followed by 8 hexadecimal digits.
+ * - @c %%c: character.
+ * - @c %%s: string (@c NULL prints as <tt>(null)</tt>).
+ * - @c %%%%: a percent sign.
+ *
+ * Each can be given the @c - flag (left justify), the @c 0 flag (pad
+ * numbers with zeros instead of spaces), and a minimum field width,
+ * either as a number or as @c * (taken from the arguments), and the
+ * @c l length modifier. Note that U32 and S32 are @c long: print them
+ * with @c %%lu, @c %%ld or @c %%lx. An unknown directive is printed as
+ * is.
+ *
+ * Decimal conversions use a multiplication by the reciprocal of 10
+ * instead of a division, which the ARM cores lack.
+ */
+/*@{*/
+
+/** Size of the buffer used by the printf functions of the drivers.
+ * Longer output is truncated.
+ */
+#define NX_PRINTF_BUFSIZE 128
+
+/** Format into @a buf.
+ *
+ * @param buf The buffer to write to.
+ * @param size The size of @a buf. The output is truncated to @a size
+ * - 1 characters, and always terminated by a NUL if @a size is not 0.
+ * @param fmt The format string.
+ *
+ * @return The length of the complete output, without the terminating
+ * NUL, even if it was truncated.
+ */
+U32 nx_snprintf(char *buf, U32 size, const char *fmt, ...)
+  __attribute__((format(printf, 3, 4)));
+
+/** Like nx_snprintf(), with the arguments in a @c va_list. */
+U32 nx_vsnprintf(char *buf, U32 size, const char *fmt, va_list ap);
+
+/*@}*/
+/*@}*/
+
+#endif /* __NXOS_BASE_FORMAT_H__ */
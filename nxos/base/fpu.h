@@ -0,0 +1,79 @@
+/** @file fpu.h
+ *  @brief Floating point unit context management.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_FPU_H__
+#define __NXOS_BASE_FPU_H__
+
+#include "base/types.h"
+
+/** @addtogroup kernel */
+/*@{*/
+
+/** @defgroup fpu Floating point unit
+ *
+ * On Cortex-A9 builds with an FPU (@c FLOATABI=hard, or @c NEON=1),
+ * the startup code turns VFP/NEON on, and the kernel switches the FPU
+ * registers lazily between execution contexts.
+ *
+ * The FPU is owned by one context at a time: its registers are live
+ * in the FPU. Whenever another context starts running (an interrupt
+ * handler, or a task after nx_fpu_switch()), the FPU is disabled
+ * instead of being saved. Only if that context executes a floating
+ * point instruction does the resulting undefined instruction trap save
+ * the registers of the owner, load the new context and resume.
+ *
+ * Code that does not use floating point, which includes most interrupt
+ * handlers, thus never pays for the 32 double registers.
+ *
+ * @note Interrupt handlers get a scratch FPU context: their floating
+ * point state is not preserved from one interrupt to the next. Nested
+ * interrupts are not supported by the lazy switching.
+ *
+ * On other builds, these functions do nothing.
+ */
+/*@{*/
+
+/** @brief Saved floating point registers of an execution context. */
+typedef struct {
+  U32 d[64]; /**< d0-d31. */
+  U32 fpscr; /**< Floating point status and control register. */
+} nx_fpu_context_t;
+
+/** Switch the FPU to another execution context.
+ *
+ * Call this from a task switcher, right before resuming a task. The
+ * registers are only loaded if the task executes a floating point
+ * instruction.
+ *
+ * @param ctx The context of the task about to run, or NULL for the
+ * kernel main context. The context must be zeroed before its first
+ * use.
+ */
+void nx_fpu_switch(nx_fpu_context_t *ctx);
+
+/** Forget a context that will never run again.
+ *
+ * @param ctx The context of a terminated task.
+ */
+void nx_fpu_release(nx_fpu_context_t *ctx);
+
+/** Return the number of lazy context loads since boot.
+ *
+ * This counts the floating point traps that actually switched the FPU
+ * registers.
+ */
+U32 nx_fpu_get_loads(void);
+
+/*@}*/
+/*@}*/
+
+#endif /* __NXOS_BASE_FPU_H__ */
@@ -58,6 +58,22 @@ void nx_interrupts_disable(void);
  */
 void nx_interrupts_enable(void);
 
+/** Disable interrupt handling, and return the previous state.
+ *
+ * Unlike nx_interrupts_disable(), this may be called from interrupt
+ * handlers. It is meant for critical sections of a few instructions,
+ * and must be paired with nx_interrupts_restore().
+ *
+ * @return The interrupt mask before the call.
+ */
+U32 nx_interrupts_save(void);
+
+/** Restore the interrupt mask saved by nx_interrupts_save().
+ *
+ * @param state The value returned by nx_interrupts_save().
+ */
+void nx_interrupts_restore(U32 state);
+
 /** @brief The mapping of a user task's registers in the User/System stack.
  *
  * This structure should be used in an interrupt handler: cast the
@@ -37,11 +37,14 @@
 \isr_vec:
 	.word	\intr_id								/**< Interrupt ID value  */
 	.word	\intr_routine							/**< Interrupt Handler pointer  */
+	.word	0										/**< Dispatch count  */
 	.endm
 
 	.equ	GIC_VEC_ENTRY_ISR_ID, 0					/**< ISR vector Interrupt ID offset */
 	.equ	GIC_VEC_ENTRY_ISR_OFFSET, 4				/**< ISR vector Interrupt Handler offset */
-	.equ	SIZEOF_GIC_VEC_ENTRY, 8					/**< ISR vector entry size */
+	.equ	GIC_VEC_ENTRY_COUNT, 8					/**< ISR vector dispatch count offset */
+	.equ	SIZEOF_GIC_VEC_ENTRY, 12				/**< ISR vector entry size */
 	.equ	INVALID_INTR_ID, 0xFFFFFFFF				/**< ISR vector Invalid Interrupt ID value */
+	.equ	IVR_FREE_ENTRIES, 8						/**< Entries available to nx_aic_install_isr() */
 
 #endif /* __IVR_TABLE_H__ */
@@ -0,0 +1,419 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/display.h"
+#include "base/drivers/uart.h"
+
+#include "base/lib/console/console.h"
+
+#define ESC 0x1B
+#define CAN 0x18
+#define SUB 0x1A
+#define DEL 0x7F
+
+#define MAX_PARAMS 4
+#define MAX_PARAM_VALUE 9999
+
+typedef enum {
+  STATE_TEXT = 0,
+  STATE_ESC,
+  STATE_CSI,
+} state_t;
+
+static struct {
+  state_t state;
+
+  /* Parameters of the escape sequence being parsed. */
+  U32 params[MAX_PARAMS];
+  U8 nparams;
+  bool private;
+
+  U8 width, height;
+
+  /* The cursor. After a character is written in the last column, the
+   * cursor stays there until the next one wraps it to the next line.
+   */
+  U8 x, y;
+  bool wrap_pending;
+  U8 saved_x, saved_y;
+
+  /* The scrolling region, inclusive. */
+  U8 top, bottom;
+} console;
+
+/* Parameter i of the current sequence, or def if absent or zero. */
+static U32 param(U8 i, U32 def) {
+  if (i < console.nparams && console.params[i] != 0)
+    return console.params[i];
+  return def;
+}
+
+static U8 clamp(S32 v, U8 max) {
+  if (v < 0)
+    return 0;
+  if (v > max)
+    return max;
+  return (U8)v;
+}
+
+static void move_to(S32 x, S32 y) {
+  console.x = clamp(x, console.width - 1);
+  console.y = clamp(y, console.height - 1);
+  console.wrap_pending = FALSE;
+}
+
+static void line_feed(void) {
+  if (console.y == console.bottom)
+    nx_display_scroll_region(console.top, console.bottom, 1);
+  else if (console.y < console.height - 1)
+    console.y++;
+}
+
+static void reverse_line_feed(void) {
+  if (console.y == console.top)
+    nx_display_scroll_region(console.top, console.bottom, -1);
+  else if (console.y > 0)
+    console.y--;
+}
+
+static void erase_lines(U8 first, U8 last) {
+  U32 y;
+
+  for (y = first; y <= last; y++)
+    nx_display_erase(0, y, console.width);
+}
+
+static void erase_display(U32 mode) {
+  switch (mode) {
+    case 0:
+      nx_display_erase(console.x, console.y, console.width - console.x);
+      if (console.y < console.height - 1)
+        erase_lines(console.y + 1, console.height - 1);
+      break;
+    case 1:
+      if (console.y > 0)
+        erase_lines(0, console.y - 1);
+      nx_display_erase(0, console.y, console.x + 1);
+      break;
+    case 2:
+      erase_lines(0, console.height - 1);
+      break;
+    default:
+      break;
+  }
+}
+
+static void erase_line(U32 mode) {
+  switch (mode) {
+    case 0:
+      nx_display_erase(console.x, console.y, console.width - console.x);
+      break;
+    case 1:
+      nx_display_erase(0, console.y, console.x + 1);
+      break;
+    case 2:
+      nx_display_erase(0, console.y, console.width);
+      break;
+    default:
+      break;
+  }
+}
+
+static void save_cursor(void) {
+  console.saved_x = console.x;
+  console.saved_y = console.y;
+}
+
+static void restore_cursor(void) {
+  move_to(console.saved_x, console.saved_y);
+}
+
+static void setup(void) {
+  console.state = STATE_TEXT;
+  console.width = nx_display_get_width();
+  console.height = nx_display_get_height();
+  console.top = 0;
+  console.bottom = console.height - 1;
+  move_to(0, 0);
+  save_cursor();
+}
+
+static void reset(void) {
+  setup();
+  erase_display(2);
+}
+
+/* Scroll lines at the cursor, for insertions and deletions. */
+static void scroll_at_cursor(S32 lines) {
+  if (console.y < console.top || console.y > console.bottom)
+    return;
+  nx_display_scroll_region(console.y, console.bottom, lines);
+  move_to(0, console.y);
+}
+
+static void csi_dispatch(U8 c) {
+  S32 n = param(0, 1);
+
+  if (console.private)
+    return; /* Modes such as cursor visibility: nothing to do. */
+
+  switch (c) {
+    case 'A':
+      move_to(console.x, console.y - n);
+      break;
+    case 'B':
+      move_to(console.x, console.y + n);
+      break;
+    case 'C':
+      move_to(console.x + n, console.y);
+      break;
+    case 'D':
+      move_to(console.x - n, console.y);
+      break;
+    case 'E':
+      move_to(0, console.y + n);
+      break;
+    case 'F':
+      move_to(0, console.y - n);
+      break;
+    case 'G':
+      move_to(n - 1, console.y);
+      break;
+    case 'd':
+      move_to(console.x, n - 1);
+      break;
+    case 'H':
+    case 'f':
+      move_to(param(1, 1) - 1, n - 1);
+      break;
+    case 'J':
+      erase_display(param(0, 0));
+      break;
+    case 'K':
+      erase_line(param(0, 0));
+      break;
+    case 'L':
+      scroll_at_cursor(-n);
+      break;
+    case 'M':
+      scroll_at_cursor(n);
+      break;
+    case 'S':
+      nx_display_scroll_region(console.top, console.bottom, n);
+      break;
+    case 'T':
+      nx_display_scroll_region(console.top, console.bottom, -n);
+      break;
+    case 'r': {
+      U32 top = param(0, 1), bottom = param(1, console.height);
+
+      if (top < bottom && bottom <= console.height) {
+        console.top = top - 1;
+        console.bottom = bottom - 1;
+        move_to(0, 0);
+      }
+      break;
+    }
+    case 's':
+      save_cursor();
+      break;
+    case 'u':
+      restore_cursor();
+      break;
+    default:
+      break; /* Including the 'm' attributes. */
+  }
+}
+
+static void esc_dispatch(U8 c) {
+  console.state = STATE_TEXT;
+
+  switch (c) {
+    case '[':
+      console.state = STATE_CSI;
+      console.nparams = 0;
+      console.params[0] = 0;
+      console.private = FALSE;
+      break;
+    case '7':
+      save_cursor();
+      break;
+    case '8':
+      restore_cursor();
+      break;
+    case 'D':
+      line_feed();
+      break;
+    case 'M':
+      reverse_line_feed();
+      break;
+    case 'E':
+      console.x = 0;
+      line_feed();
+      break;
+    case 'c':
+      reset();
+      break;
+    default:
+      break;
+  }
+}
+
+static void csi_byte(U8 c) {
+  if (c >= '0' && c <= '9') {
+    if (console.nparams == 0)
+      console.nparams = 1;
+    if (console.nparams <= MAX_PARAMS &&
+        console.params[console.nparams - 1] <= MAX_PARAM_VALUE)
+      console.params[console.nparams - 1] =
+        console.params[console.nparams - 1] * 10 + (c - '0');
+  } else if (c == ';') {
+    if (console.nparams == 0)
+      console.nparams = 1;
+    if (console.nparams < MAX_PARAMS)
+      console.params[console.nparams] = 0;
+    console.nparams++;
+  } else if (c >= '<' && c <= '?') {
+    console.private = TRUE;
+  } else if (c >= 0x40 && c <= 0x7E) {
+    if (console.nparams > MAX_PARAMS)
+      console.nparams = MAX_PARAMS;
+    console.state = STATE_TEXT;
+    csi_dispatch(c);
+  }
+  /* Intermediate bytes are ignored. */
+}
+
+static void control(U8 c) {
+  switch (c) {
+    case '\b':
+      if (console.x > 0)
+        console.x--;
+      console.wrap_pending = FALSE;
+      break;
+    case '\t':
+      move_to((console.x + 8) & ~7, console.y);
+      break;
+    case '\n':
+    case '\v':
+    case '\f':
+      line_feed();
+      console.wrap_pending = FALSE;
+      break;
+    case '\r':
+      console.x = 0;
+      console.wrap_pending = FALSE;
+      break;
+    case ESC:
+      console.state = STATE_ESC;
+      break;
+    case CAN:
+    case SUB:
+      console.state = STATE_TEXT;
+      break;
+    default:
+      break;
+  }
+}
+
+static inline bool printable(U8 c) {
+  return c >= 0x20 && c != DEL;
+}
+
+/* Display the run of printable characters at the start of buf, up to
+ * the end of the line, and return its length.
+ */
+static U32 text(const U8 *buf, U32 len) {
+  U32 n = 0, room;
+
+  if (console.wrap_pending) {
+    console.x = 0;
+    line_feed();
+    console.wrap_pending = FALSE;
+  }
+
+  room = MIN(len, (U32)(console.width - console.x));
+  while (n < room && printable(buf[n]))
+    n++;
+
+  nx_display_write_at(console.x, console.y, (const char *)buf, n);
+  if (console.x + n >= console.width) {
+    console.x = console.width - 1;
+    console.wrap_pending = TRUE;
+  } else {
+    console.x += n;
+  }
+
+  return n;
+}
+
+void nx_console_init(void) {
+  nx_display_begin();
+  reset();
+  nx_display_cursor_set_pos(0, 0);
+  nx_display_commit();
+}
+
+void nx_console_write(const U8 *buf, U32 len) {
+  U32 i = 0;
+  U8 c;
+
+  /* Without nx_console_init(), start over the current screen. */
+  if (console.width == 0)
+    setup();
+
+  nx_display_begin();
+  while (i < len) {
+    c = buf[i];
+
+    switch (console.state) {
+      case STATE_TEXT:
+        if (printable(c)) {
+          i += text(&buf[i], len - i);
+          continue;
+        }
+        control(c);
+        break;
+      case STATE_ESC:
+        if (c < 0x20)
+          control(c);
+        else
+          esc_dispatch(c);
+        break;
+      case STATE_CSI:
+        if (c < 0x20)
+          control(c);
+        else
+          csi_byte(c);
+        break;
+    }
+    i++;
+  }
+
+  nx_display_cursor_set_pos(console.x, console.y);
+  nx_display_commit();
+}
+
+void nx_console_string(const char *str) {
+  nx_console_write((const U8 *)str, strlen(str));
+}
+
+U32 nx_console_poll_uart(void) {
+  U8 buf[UART_RXBUFSIZE];
+  U32 len, total = 0;
+
+  do {
+    nx_uart_readbuf(buf, &len);
+    nx_console_write(buf, len);
+    total += len;
+  } while (len > 0);
+
+  return total;
+}
@@ -0,0 +1,91 @@
+/** @file console.h
+ *  @brief ANSI terminal emulation on the text display.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_LIB_CONSOLE_H__
+#define __NXOS_BASE_LIB_CONSOLE_H__
+
+#include "base/types.h"
+
+/** @addtogroup lib */
+/*@{*/
+
+/** @defgroup console ANSI console
+ *
+ * A VT100 style terminal in front of the text display. Text written to
+ * the console may embed escape sequences, so that a whole screen
+ * update, e.g. a dashboard streamed by a host program over the UART,
+ * is a single write and can be replayed from a capture.
+ *
+ * Supported control characters are BS, HT, LF, VT, FF (line feed)
+ * and CR. Supported escape sequences (@a n and @a m are decimal
+ * parameters, 1 by default; positions start at 1):
+ *
+ * - <tt>ESC [ n ; m H</tt>, <tt>ESC [ n ; m f</tt>: move to line @a n,
+ *   column @a m.
+ * - <tt>ESC [ n A</tt>, @c B, @c C, @c D: move up, down, right, left.
+ * - <tt>ESC [ n E</tt>, @c F: move to the start of a following or
+ *   preceding line.
+ * - <tt>ESC [ n G</tt>, <tt>ESC [ n d</tt>: move to column, or line,
+ *   @a n.
+ * - <tt>ESC [ n J</tt>: erase to the end (0, the default), the start
+ *   (1) or all (2) of the screen.
+ * - <tt>ESC [ n K</tt>: erase to the end (0), the start (1) or all
+ *   (2) of the line.
+ * - <tt>ESC [ n ; m r</tt>: restrict scrolling to lines @a n to @a m
+ *   (the whole screen by default).
+ * - <tt>ESC [ n S</tt>, @c T: scroll the region up, or down.
+ * - <tt>ESC [ n L</tt>, @c M: insert, or delete, lines at the cursor.
+ * - <tt>ESC [ s</tt>, <tt>ESC 7</tt>: save the cursor;
+ *   <tt>ESC [ u</tt>, <tt>ESC 8</tt>: restore it.
+ * - <tt>ESC D</tt>, <tt>ESC M</tt>, <tt>ESC E</tt>: index, reverse
+ *   index, next line.
+ * - <tt>ESC c</tt>: reset the terminal and clear the screen.
+ *
+ * Other sequences, including attributes (<tt>ESC [ ... m</tt>) that
+ * the text display cannot show, are parsed and ignored.
+ *
+ * The console keeps its own cursor, and moves the display cursor to
+ * it after each write. The whole write is refreshed at once.
+ */
+/*@{*/
+
+/** Reset the terminal state and clear the screen. */
+void nx_console_init(void);
+
+/** Write @a len bytes of terminal output.
+ *
+ * Escape sequences may be split across writes.
+ *
+ * @param buf The bytes to write.
+ * @param len The number of bytes.
+ */
+void nx_console_write(const U8 *buf, U32 len);
+
+/** Write the string @a str of terminal output.
+ *
+ * @param str The string to write.
+ */
+void nx_console_string(const char *str);
+
+/** Write the bytes waiting on the UART to the console.
+ *
+ * This does not block. Call it from the main loop to show a terminal
+ * stream sent by the host.
+ *
+ * @return The number of bytes written.
+ */
+U32 nx_console_poll_uart(void);
+
+/*@}*/
+/*@}*/
+
+#endif /* __NXOS_BASE_LIB_CONSOLE_H__ */
@@ -0,0 +1,50 @@
+/** @file _gfx.h
+ *  @brief 2D graphics library internals.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_LIB_GFX__GFX_H__
+#define __NXOS_BASE_LIB_GFX__GFX_H__
+
+#include "base/lib/gfx/gfx.h"
+
+/** @addtogroup gfx */
+/*@{*/
+
+/** A pixel pair, to access the 16 bit pixels a word at a time. The
+ * stores must not be reordered against 16 bit accesses to the same
+ * buffer.
+ */
+typedef U32 __attribute__((may_alias)) nx__gfx_pair_t;
+
+/** Check whether pixel (@a x, @a y) is in the clip rectangle of @a s. */
+static inline bool nx__gfx_in_clip(const nx_gfx_surface_t *s, S32 x, S32 y) {
+  return ((U32)(x - s->clip.x) < (U32)s->clip.w &&
+          (U32)(y - s->clip.y) < (U32)s->clip.h) ? TRUE : FALSE;
+}
+
+/** Check whether the rectangle at (@a x, @a y) of size @a w x @a h
+ * is entirely in the clip rectangle of @a s.
+ */
+static inline bool nx__gfx_rect_in_clip(const nx_gfx_surface_t *s,
+                                        S32 x, S32 y, S32 w, S32 h) {
+  return (x >= s->clip.x && y >= s->clip.y &&
+          x + w <= s->clip.x + s->clip.w &&
+          y + h <= s->clip.y + s->clip.h) ? TRUE : FALSE;
+}
+
+/** Return the address of pixel (@a x, @a y) of @a s. */
+static inline U16 *nx__gfx_pixel_ptr(const nx_gfx_surface_t *s, S32 x, S32 y) {
+  return s->pixels + y * s->stride + x;
+}
+
+/*@}*/
+
+#endif /* __NXOS_BASE_LIB_GFX__GFX_H__ */
@@ -0,0 +1,363 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/assert.h"
+#ifdef __DE1SOC__
+#include "base/drivers/fb.h"
+#endif
+
+#include "base/lib/gfx/_gfx.h"
+
+/* Fill n pixels from p. After an optional leading pixel, the span is
+ * written as aligned pixel pairs, 8 words at a time (a single STM).
+ */
+static inline void fill_span(U16 *p, U32 n, U16 color) {
+  U32 pair = color | ((U32)color << 16);
+  nx__gfx_pair_t *w;
+
+  if (n != 0 && ((U32)p & 2)) {
+    *p++ = color;
+    n--;
+  }
+
+  w = (nx__gfx_pair_t *)p;
+  for (; n >= 16; n -= 16, w += 8) {
+    w[0] = pair; w[1] = pair; w[2] = pair; w[3] = pair;
+    w[4] = pair; w[5] = pair; w[6] = pair; w[7] = pair;
+  }
+  for (; n >= 2; n -= 2)
+    *w++ = pair;
+
+  if (n != 0)
+    *(U16 *)w = color;
+}
+
+/* Copy n pixels of a color keyed span. Pixel pairs are tested and
+ * stored a word at a time when both spans have the same alignment.
+ */
+static void copy_span_key(U16 *d, const U16 *s, U32 n, U16 key) {
+  nx__gfx_pair_t *dw;
+  const nx__gfx_pair_t *sw;
+  U32 v;
+
+  if (((U32)d ^ (U32)s) & 2) {
+    for (; n != 0; n--, d++, s++)
+      if (*s != key)
+        *d = *s;
+    return;
+  }
+
+  if (n != 0 && ((U32)d & 2)) {
+    if (*s != key)
+      *d = *s;
+    d++;
+    s++;
+    n--;
+  }
+
+  dw = (nx__gfx_pair_t *)d;
+  sw = (const nx__gfx_pair_t *)s;
+  for (; n >= 2; n -= 2, dw++, sw++) {
+    v = *sw;
+    if ((v & 0xFFFF) != key) {
+      if ((v >> 16) != key)
+        *dw = v;
+      else
+        *(U16 *)dw = (U16)v;
+    } else if ((v >> 16) != key) {
+      *((U16 *)dw + 1) = (U16)(v >> 16);
+    }
+  }
+
+  if (n != 0 && *(const U16 *)sw != key)
+    *(U16 *)dw = *(const U16 *)sw;
+}
+
+/* Intersect r with the clip rectangle of s. Return FALSE if nothing
+ * is left.
+ */
+static bool clip_rect(const nx_gfx_surface_t *s, nx_gfx_rect_t *r) {
+  S32 x1 = r->x + r->w, y1 = r->y + r->h;
+  S32 cx1 = s->clip.x + s->clip.w, cy1 = s->clip.y + s->clip.h;
+
+  if (r->x < s->clip.x)
+    r->x = s->clip.x;
+  if (r->y < s->clip.y)
+    r->y = s->clip.y;
+  if (x1 > cx1)
+    x1 = cx1;
+  if (y1 > cy1)
+    y1 = cy1;
+
+  r->w = x1 - r->x;
+  r->h = y1 - r->y;
+  return (r->w > 0 && r->h > 0) ? TRUE : FALSE;
+}
+
+void nx_gfx_surface_init(nx_gfx_surface_t *s, U16 *pixels,
+                         S32 width, S32 height, S32 stride) {
+  NX_ASSERT(width >= 0 && height >= 0 && stride >= width);
+
+  s->pixels = pixels;
+  s->width = width;
+  s->height = height;
+  s->stride = stride;
+  nx_gfx_set_clip(s, NULL);
+}
+
+#ifdef __DE1SOC__
+void nx_gfx_surface_back_buffer(nx_gfx_surface_t *s) {
+  nx_gfx_surface_init(s, nx_fb_get_back_buffer(),
+                      NX_FB_WIDTH, NX_FB_HEIGHT, NX_FB_STRIDE);
+}
+#endif
+
+void nx_gfx_set_clip(nx_gfx_surface_t *s, const nx_gfx_rect_t *r) {
+  s->clip.x = 0;
+  s->clip.y = 0;
+  s->clip.w = s->width;
+  s->clip.h = s->height;
+
+  if (r != NULL) {
+    nx_gfx_rect_t c = *r;
+
+    if (!clip_rect(s, &c))
+      c.w = c.h = 0;
+    s->clip = c;
+  }
+}
+
+void nx_gfx_clear(nx_gfx_surface_t *s, U16 color) {
+  nx_gfx_fill_rect(s, &s->clip, color);
+}
+
+void nx_gfx_pixel(nx_gfx_surface_t *s, S32 x, S32 y, U16 color) {
+  if (nx__gfx_in_clip(s, x, y))
+    *nx__gfx_pixel_ptr(s, x, y) = color;
+}
+
+void nx_gfx_hspan(nx_gfx_surface_t *s, S32 x, S32 y, S32 len, U16 color) {
+  nx_gfx_rect_t r = { x, y, len, 1 };
+
+  if (clip_rect(s, &r))
+    fill_span(nx__gfx_pixel_ptr(s, r.x, r.y), r.w, color);
+}
+
+void nx_gfx_vspan(nx_gfx_surface_t *s, S32 x, S32 y, S32 len, U16 color) {
+  nx_gfx_rect_t r = { x, y, 1, len };
+  U16 *p;
+
+  if (!clip_rect(s, &r))
+    return;
+
+  for (p = nx__gfx_pixel_ptr(s, r.x, r.y); r.h != 0; r.h--, p += s->stride)
+    *p = color;
+}
+
+void nx_gfx_fill_rect(nx_gfx_surface_t *s, const nx_gfx_rect_t *r, U16 color) {
+  nx_gfx_rect_t c = *r;
+  U16 *p;
+
+  if (!clip_rect(s, &c))
+    return;
+
+  for (p = nx__gfx_pixel_ptr(s, c.x, c.y); c.h != 0; c.h--, p += s->stride)
+    fill_span(p, c.w, color);
+}
+
+void nx_gfx_rect(nx_gfx_surface_t *s, const nx_gfx_rect_t *r, U16 color) {
+  if (r->w <= 0 || r->h <= 0)
+    return;
+
+  nx_gfx_hspan(s, r->x, r->y, r->w, color);
+  if (r->h > 1)
+    nx_gfx_hspan(s, r->x, r->y + r->h - 1, r->w, color);
+  if (r->h > 2) {
+    nx_gfx_vspan(s, r->x, r->y + 1, r->h - 2, color);
+    if (r->w > 1)
+      nx_gfx_vspan(s, r->x + r->w - 1, r->y + 1, r->h - 2, color);
+  }
+}
+
+void nx_gfx_line(nx_gfx_surface_t *s, S32 x0, S32 y0, S32 x1, S32 y1,
+                 U16 color) {
+  S32 dx, dy, sx, sy, err, e2;
+  bool inside;
+  nx_gfx_rect_t bounds;
+
+  /* Axis aligned lines are spans. */
+  if (y0 == y1) {
+    nx_gfx_hspan(s, MIN(x0, x1), y0, (x0 < x1 ? x1 - x0 : x0 - x1) + 1, color);
+    return;
+  }
+  if (x0 == x1) {
+    nx_gfx_vspan(s, x0, MIN(y0, y1), (y0 < y1 ? y1 - y0 : y0 - y1) + 1, color);
+    return;
+  }
+
+  dx = x1 > x0 ? x1 - x0 : x0 - x1;
+  dy = y1 > y0 ? y1 - y0 : y0 - y1;
+  sx = x0 < x1 ? 1 : -1;
+  sy = y0 < y1 ? 1 : -1;
+
+  /* Skip lines entirely out of the clip rectangle, and the per pixel
+   * clip test for lines entirely in it.
+   */
+  bounds.x = MIN(x0, x1);
+  bounds.y = MIN(y0, y1);
+  bounds.w = dx + 1;
+  bounds.h = dy + 1;
+  if (!clip_rect(s, &bounds))
+    return;
+  inside = (bounds.w == dx + 1 && bounds.h == dy + 1) ? TRUE : FALSE;
+
+  err = dx - dy;
+  while (1) {
+    if (inside || nx__gfx_in_clip(s, x0, y0))
+      *nx__gfx_pixel_ptr(s, x0, y0) = color;
+    if (x0 == x1 && y0 == y1)
+      break;
+    e2 = 2 * err;
+    if (e2 > -dy) {
+      err -= dy;
+      x0 += sx;
+    }
+    if (e2 < dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+void nx_gfx_circle(nx_gfx_surface_t *s, S32 cx, S32 cy, S32 r, U16 color) {
+  S32 x = r, y = 0, d = 1 - r;
+
+  if (r < 0)
+    return;
+
+  while (y <= x) {
+    nx_gfx_pixel(s, cx + x, cy + y, color);
+    nx_gfx_pixel(s, cx - x, cy + y, color);
+    nx_gfx_pixel(s, cx + x, cy - y, color);
+    nx_gfx_pixel(s, cx - x, cy - y, color);
+    nx_gfx_pixel(s, cx + y, cy + x, color);
+    nx_gfx_pixel(s, cx - y, cy + x, color);
+    nx_gfx_pixel(s, cx + y, cy - x, color);
+    nx_gfx_pixel(s, cx - y, cy - x, color);
+
+    y++;
+    if (d < 0) {
+      d += 2 * y + 1;
+    } else {
+      x--;
+      d += 2 * (y - x) + 1;
+    }
+  }
+}
+
+void nx_gfx_fill_circle(nx_gfx_surface_t *s, S32 cx, S32 cy, S32 r,
+                        U16 color) {
+  S32 x = r, y = 0, d = 1 - r;
+
+  if (r < 0)
+    return;
+
+  /* Every line of the disc is filled exactly once: the lines at
+   * distance y from the center as y grows, and those at distance x
+   * when x is about to shrink, by which time their width is final.
+   */
+  while (y <= x) {
+    nx_gfx_hspan(s, cx - x, cy + y, 2 * x + 1, color);
+    if (y != 0)
+      nx_gfx_hspan(s, cx - x, cy - y, 2 * x + 1, color);
+
+    if (d >= 0 && x > y) {
+      nx_gfx_hspan(s, cx - y, cy + x, 2 * y + 1, color);
+      nx_gfx_hspan(s, cx - y, cy - x, 2 * y + 1, color);
+    }
+
+    y++;
+    if (d < 0) {
+      d += 2 * y + 1;
+    } else {
+      x--;
+      d += 2 * (y - x) + 1;
+    }
+  }
+}
+
+/* Clip a blit of rectangle *r of src to (*x, *y) on dst. */
+static bool clip_blit(const nx_gfx_surface_t *dst, S32 *x, S32 *y,
+                      const nx_gfx_surface_t *src, nx_gfx_rect_t *r) {
+  nx_gfx_rect_t d;
+
+  /* Source bounds. */
+  if (r->x < 0) {
+    r->w += r->x;
+    *x -= r->x;
+    r->x = 0;
+  }
+  if (r->y < 0) {
+    r->h += r->y;
+    *y -= r->y;
+    r->y = 0;
+  }
+  if (r->x + r->w > src->width)
+    r->w = src->width - r->x;
+  if (r->y + r->h > src->height)
+    r->h = src->height - r->y;
+
+  /* Destination clip rectangle. */
+  d.x = *x;
+  d.y = *y;
+  d.w = r->w;
+  d.h = r->h;
+  if (r->w <= 0 || r->h <= 0 || !clip_rect(dst, &d))
+    return FALSE;
+
+  r->x += d.x - *x;
+  r->y += d.y - *y;
+  r->w = d.w;
+  r->h = d.h;
+  *x = d.x;
+  *y = d.y;
+  return TRUE;
+}
+
+void nx_gfx_blit(nx_gfx_surface_t *dst, S32 x, S32 y,
+                 const nx_gfx_surface_t *src, const nx_gfx_rect_t *r) {
+  nx_gfx_rect_t c = *r;
+  U16 *d;
+  const U16 *s;
+
+  if (!clip_blit(dst, &x, &y, src, &c))
+    return;
+
+  d = nx__gfx_pixel_ptr(dst, x, y);
+  s = nx__gfx_pixel_ptr(src, c.x, c.y);
+  for (; c.h != 0; c.h--, d += dst->stride, s += src->stride)
+    memcpy(d, s, c.w * sizeof(U16));
+}
+
+void nx_gfx_blit_key(nx_gfx_surface_t *dst, S32 x, S32 y,
+                     const nx_gfx_surface_t *src, const nx_gfx_rect_t *r,
+                     U16 key) {
+  nx_gfx_rect_t c = *r;
+  U16 *d;
+  const U16 *s;
+
+  if (!clip_blit(dst, &x, &y, src, &c))
+    return;
+
+  d = nx__gfx_pixel_ptr(dst, x, y);
+  s = nx__gfx_pixel_ptr(src, c.x, c.y);
+  for (; c.h != 0; c.h--, d += dst->stride, s += src->stride)
+    copy_span_key(d, s, c.w, key);
+}
@@ -0,0 +1,255 @@
+/** @file gfx.h
+ *  @brief 2D raster graphics primitives.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_LIB_GFX_H__
+#define __NXOS_BASE_LIB_GFX_H__
+
+#include "base/types.h"
+
+/** @addtogroup lib */
+/*@{*/
+
+/** @defgroup gfx 2D graphics
+ *
+ * Drawing primitives for 16-bit RGB565 pixel surfaces: the back buffer
+ * of the pixel framebuffer (see fb.h), or any off-screen bitmap.
+ *
+ * Every primitive is clipped to the clip rectangle of its surface, so
+ * coordinates may lie outside of it. Horizontal runs of pixels are
+ * written as aligned pixel pairs, in bursts of 8 words, which makes
+ * rectangle fills and blits much faster than pixel by pixel loops.
+ *
+ * Text is drawn with the embedded 5x8 font, in cells of
+ * NX_GFX_CHAR_WIDTH x NX_GFX_CHAR_HEIGHT pixels. The glyphs are
+ * expanded to pixels once per color pair, in a small cache, so that
+ * opaque text at even x coordinates is drawn with word stores only.
+ *
+ * The compositor keeps track of a background and of sprites drawn over
+ * it, and only redraws the regions of the screen that changed from
+ * one frame to the next.
+ */
+/*@{*/
+
+/** @brief A rectangle. */
+typedef struct {
+  S32 x; /**< Left edge. */
+  S32 y; /**< Top edge. */
+  S32 w; /**< Width, in pixels. */
+  S32 h; /**< Height, in pixels. */
+} nx_gfx_rect_t;
+
+/** @brief A surface to draw on. */
+typedef struct {
+  U16 *pixels; /**< The top-left pixel. */
+  S32 width; /**< Width, in pixels. */
+  S32 height; /**< Height, in pixels. */
+  S32 stride; /**< Distance between two lines, in pixels. */
+  nx_gfx_rect_t clip; /**< Drawing is restricted to this rectangle. */
+} nx_gfx_surface_t;
+
+/** Set up a surface over a pixel buffer.
+ *
+ * The clip rectangle covers the whole surface.
+ *
+ * @param s The surface to set up.
+ * @param pixels The top-left pixel. It should be 4 byte aligned, as
+ * should @a stride pixels, for the fastest fills.
+ * @param width The width, in pixels.
+ * @param height The height, in pixels.
+ * @param stride The distance between two lines, in pixels.
+ */
+void nx_gfx_surface_init(nx_gfx_surface_t *s, U16 *pixels,
+                         S32 width, S32 height, S32 stride);
+
+#ifdef __DE1SOC__
+/** Set up a surface over the current back buffer of the framebuffer.
+ *
+ * @note The surface must be set up again after each nx_fb_swap().
+ */
+void nx_gfx_surface_back_buffer(nx_gfx_surface_t *s);
+#endif
+
+/** Restrict drawing on @a s to @a r, or to the whole surface if @a r
+ * is NULL. The clip rectangle is always kept within the surface.
+ */
+void nx_gfx_set_clip(nx_gfx_surface_t *s, const nx_gfx_rect_t *r);
+
+/** Fill the whole clip rectangle with @a color. */
+void nx_gfx_clear(nx_gfx_surface_t *s, U16 color);
+
+/** Set the pixel at (@a x, @a y). */
+void nx_gfx_pixel(nx_gfx_surface_t *s, S32 x, S32 y, U16 color);
+
+/** Draw a horizontal span of @a len pixels, rightwards from (@a x, @a y). */
+void nx_gfx_hspan(nx_gfx_surface_t *s, S32 x, S32 y, S32 len, U16 color);
+
+/** Draw a vertical span of @a len pixels, downwards from (@a x, @a y). */
+void nx_gfx_vspan(nx_gfx_surface_t *s, S32 x, S32 y, S32 len, U16 color);
+
+/** Fill the rectangle @a r. */
+void nx_gfx_fill_rect(nx_gfx_surface_t *s, const nx_gfx_rect_t *r, U16 color);
+
+/** Draw the 1 pixel wide outline of the rectangle @a r. */
+void nx_gfx_rect(nx_gfx_surface_t *s, const nx_gfx_rect_t *r, U16 color);
+
+/** Draw a line from (@a x0, @a y0) to (@a x1, @a y1), both included. */
+void nx_gfx_line(nx_gfx_surface_t *s, S32 x0, S32 y0, S32 x1, S32 y1,
+                 U16 color);
+
+/** Draw the outline of the circle of center (@a cx, @a cy) and radius
+ * @a r.
+ */
+void nx_gfx_circle(nx_gfx_surface_t *s, S32 cx, S32 cy, S32 r, U16 color);
+
+/** Fill the disc of center (@a cx, @a cy) and radius @a r. */
+void nx_gfx_fill_circle(nx_gfx_surface_t *s, S32 cx, S32 cy, S32 r,
+                        U16 color);
+
+/** Copy the rectangle @a r of @a src to (@a x, @a y) on @a dst.
+ *
+ * @a r is clipped to the bounds of @a src, and the destination to the
+ * clip rectangle of @a dst. The surfaces must not overlap.
+ */
+void nx_gfx_blit(nx_gfx_surface_t *dst, S32 x, S32 y,
+                 const nx_gfx_surface_t *src, const nx_gfx_rect_t *r);
+
+/** Like nx_gfx_blit(), but pixels of @a src of color @a key are not
+ * copied.
+ */
+void nx_gfx_blit_key(nx_gfx_surface_t *dst, S32 x, S32 y,
+                     const nx_gfx_surface_t *src, const nx_gfx_rect_t *r,
+                     U16 key);
+
+/** @name Text */
+/*@{*/
+
+#define NX_GFX_CHAR_WIDTH 6 /**< Width of a character cell, in pixels. */
+#define NX_GFX_CHAR_HEIGHT 8 /**< Height of a character cell, in pixels. */
+
+/** Draw @a str at (@a x, @a y), in @a fg over @a bg.
+ *
+ * The whole character cells are drawn, including the spacing between
+ * characters. A newline in @a str continues on the next line, at @a
+ * x. Unprintable characters are drawn as spaces.
+ *
+ * @note A few color pairs are cached at a time: drawing with many
+ * different pairs in turn is slower.
+ */
+void nx_gfx_text(nx_gfx_surface_t *s, S32 x, S32 y, const char *str,
+                 U16 fg, U16 bg);
+
+/** Draw @a str at (@a x, @a y) in @a fg, leaving the background as is. */
+void nx_gfx_text_transparent(nx_gfx_surface_t *s, S32 x, S32 y,
+                             const char *str, U16 fg);
+/*@}*/
+
+/** @name Compositor
+ *
+ * A compositor draws frames made of a background, redrawn by a
+ * callback, and of sprites over it, in the order they were added.
+ * Moving, showing, hiding or changing a sprite marks the regions it
+ * covered and now covers as changed; nx_gfx_comp_invalidate() marks
+ * changes of the background. Overlapping or nearby changed regions are
+ * merged, and nx_gfx_comp_render() redraws only these, with the
+ * surface clipped to each of them in turn.
+ *
+ * The frames are assumed to be rendered into the two buffers of the
+ * framebuffer in turn: the regions changed in the previous frame are
+ * redrawn too, since the back buffer does not have them yet.
+ */
+/*@{*/
+
+/** Maximum number of separate changed regions per frame. Beyond that,
+ * the regions that cost the least to merge are merged.
+ */
+#define NX_GFX_COMP_MAX_RECTS 16
+
+/** @brief A sprite. The fields are private. */
+typedef struct nx_gfx_sprite {
+  const nx_gfx_surface_t *image;
+  S32 x, y;
+  bool visible;
+  bool keyed;
+  U16 key;
+  bool changed;
+  bool drawn;
+  nx_gfx_rect_t drawn_rect;
+  struct nx_gfx_sprite *next;
+} nx_gfx_sprite_t;
+
+/** Callback redrawing the background on @a s.
+ *
+ * It may simply redraw all of it: the surface is clipped to the region
+ * being updated, so only that region is really drawn. It should draw
+ * every pixel of the clip rectangle.
+ */
+typedef void (*nx_gfx_comp_background_t)(nx_gfx_surface_t *s, void *arg);
+
+/** @brief A compositor. The fields are private. */
+typedef struct {
+  S32 width, height;
+  nx_gfx_comp_background_t background;
+  void *arg;
+  nx_gfx_sprite_t *sprites;
+  nx_gfx_rect_t rects[NX_GFX_COMP_MAX_RECTS];
+  U32 n_rects;
+  nx_gfx_rect_t prev_rects[NX_GFX_COMP_MAX_RECTS];
+  U32 n_prev_rects;
+  U8 full_frames;
+} nx_gfx_comp_t;
+
+/** Set up a compositor for a screen of @a width x @a height pixels.
+ *
+ * The first two frames are redrawn entirely.
+ */
+void nx_gfx_comp_init(nx_gfx_comp_t *c, S32 width, S32 height,
+                      nx_gfx_comp_background_t background, void *arg);
+
+/** Set up a sprite showing @a image at (@a x, @a y). It is initially
+ * hidden.
+ */
+void nx_gfx_sprite_init(nx_gfx_sprite_t *sp, const nx_gfx_surface_t *image,
+                        S32 x, S32 y);
+
+/** Draw the sprite without its pixels of color @a key. */
+void nx_gfx_sprite_set_key(nx_gfx_sprite_t *sp, U16 key);
+
+/** Move the sprite to (@a x, @a y). */
+void nx_gfx_sprite_move(nx_gfx_sprite_t *sp, S32 x, S32 y);
+
+/** Show or hide the sprite. */
+void nx_gfx_sprite_show(nx_gfx_sprite_t *sp, bool visible);
+
+/** Change the image of the sprite, or tell that its pixels changed. */
+void nx_gfx_sprite_set_image(nx_gfx_sprite_t *sp, const nx_gfx_surface_t *image);
+
+/** Add a sprite on top of the others. */
+void nx_gfx_comp_add_sprite(nx_gfx_comp_t *c, nx_gfx_sprite_t *sp);
+
+/** Mark the region @a r of the background as changed. */
+void nx_gfx_comp_invalidate(nx_gfx_comp_t *c, const nx_gfx_rect_t *r);
+
+/** Mark the whole screen as changed. */
+void nx_gfx_comp_invalidate_all(nx_gfx_comp_t *c);
+
+/** Redraw the changed regions into @a back, the back buffer.
+ *
+ * @return The number of pixels redrawn.
+ */
+U32 nx_gfx_comp_render(nx_gfx_comp_t *c, nx_gfx_surface_t *back);
+
+/*@}*/
+
+/*@}*/
+/*@}*/
+
+#endif /* __NXOS_BASE_LIB_GFX_H__ */
@@ -0,0 +1,238 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/assert.h"
+
+#include "base/lib/gfx/_gfx.h"
+
+/* Both buffers of the framebuffer must be redrawn after a full
+ * invalidation.
+ */
+#define FULL_FRAMES 2
+
+static inline U32 area(const nx_gfx_rect_t *r) {
+  return (U32)r->w * (U32)r->h;
+}
+
+static void rect_union(nx_gfx_rect_t *u, const nx_gfx_rect_t *a,
+                       const nx_gfx_rect_t *b) {
+  S32 x1 = MAX(a->x + a->w, b->x + b->w);
+  S32 y1 = MAX(a->y + a->h, b->y + b->h);
+
+  u->x = MIN(a->x, b->x);
+  u->y = MIN(a->y, b->y);
+  u->w = x1 - u->x;
+  u->h = y1 - u->y;
+}
+
+/* Clip r to the screen. Return FALSE if nothing is left. */
+static bool clip_screen(const nx_gfx_comp_t *c, nx_gfx_rect_t *r) {
+  S32 x1 = MIN(r->x + r->w, c->width), y1 = MIN(r->y + r->h, c->height);
+
+  r->x = MAX(r->x, 0);
+  r->y = MAX(r->y, 0);
+  r->w = x1 - r->x;
+  r->h = y1 - r->y;
+  return (r->w > 0 && r->h > 0) ? TRUE : FALSE;
+}
+
+/* Add a region to a list, merging it with the regions it overlaps or
+ * nearly touches: those whose union costs no more to redraw than both
+ * separately. When the list is full, the region is merged with the one
+ * that makes the union grow the least.
+ */
+static void add_rect(nx_gfx_rect_t *rects, U32 *n, const nx_gfx_rect_t *r) {
+  nx_gfx_rect_t cur = *r, u;
+  U32 i, best = 0, cost, best_cost = 0xFFFFFFFF;
+
+ again:
+  for (i = 0; i < *n; i++) {
+    rect_union(&u, &rects[i], &cur);
+    if (area(&u) <= area(&rects[i]) + area(&cur)) {
+      cur = u;
+      rects[i] = rects[--(*n)];
+      goto again;
+    }
+  }
+
+  if (*n == NX_GFX_COMP_MAX_RECTS) {
+    for (i = 0; i < *n; i++) {
+      rect_union(&u, &rects[i], &cur);
+      cost = area(&u) - area(&rects[i]);
+      if (cost < best_cost) {
+        best_cost = cost;
+        best = i;
+      }
+    }
+    rect_union(&cur, &rects[best], &cur);
+    rects[best] = rects[--(*n)];
+    goto again;
+  }
+
+  rects[(*n)++] = cur;
+}
+
+static void sprite_rect(const nx_gfx_sprite_t *sp, nx_gfx_rect_t *r) {
+  r->x = sp->x;
+  r->y = sp->y;
+  r->w = sp->image->width;
+  r->h = sp->image->height;
+}
+
+void nx_gfx_comp_init(nx_gfx_comp_t *c, S32 width, S32 height,
+                      nx_gfx_comp_background_t background, void *arg) {
+  NX_ASSERT(background != NULL);
+
+  c->width = width;
+  c->height = height;
+  c->background = background;
+  c->arg = arg;
+  c->sprites = NULL;
+  c->n_rects = 0;
+  c->n_prev_rects = 0;
+  c->full_frames = FULL_FRAMES;
+}
+
+void nx_gfx_sprite_init(nx_gfx_sprite_t *sp, const nx_gfx_surface_t *image,
+                        S32 x, S32 y) {
+  sp->image = image;
+  sp->x = x;
+  sp->y = y;
+  sp->visible = FALSE;
+  sp->keyed = FALSE;
+  sp->key = 0;
+  sp->changed = FALSE;
+  sp->drawn = FALSE;
+  sp->next = NULL;
+}
+
+void nx_gfx_sprite_set_key(nx_gfx_sprite_t *sp, U16 key) {
+  sp->keyed = TRUE;
+  sp->key = key;
+  sp->changed = TRUE;
+}
+
+void nx_gfx_sprite_move(nx_gfx_sprite_t *sp, S32 x, S32 y) {
+  if (x != sp->x || y != sp->y) {
+    sp->x = x;
+    sp->y = y;
+    sp->changed = TRUE;
+  }
+}
+
+void nx_gfx_sprite_show(nx_gfx_sprite_t *sp, bool visible) {
+  if (visible != sp->visible) {
+    sp->visible = visible;
+    sp->changed = TRUE;
+  }
+}
+
+void nx_gfx_sprite_set_image(nx_gfx_sprite_t *sp, const nx_gfx_surface_t *image) {
+  sp->image = image;
+  sp->changed = TRUE;
+}
+
+void nx_gfx_comp_add_sprite(nx_gfx_comp_t *c, nx_gfx_sprite_t *sp) {
+  nx_gfx_sprite_t **last = &c->sprites;
+
+  while (*last != NULL)
+    last = &(*last)->next;
+  *last = sp;
+  sp->next = NULL;
+  sp->changed = TRUE;
+}
+
+void nx_gfx_comp_invalidate(nx_gfx_comp_t *c, const nx_gfx_rect_t *r) {
+  nx_gfx_rect_t cr = *r;
+
+  if (clip_screen(c, &cr))
+    add_rect(c->rects, &c->n_rects, &cr);
+}
+
+void nx_gfx_comp_invalidate_all(nx_gfx_comp_t *c) {
+  c->full_frames = FULL_FRAMES;
+}
+
+/* Redraw one region: the background, then the sprites over it. */
+static void render_rect(nx_gfx_comp_t *c, nx_gfx_surface_t *back,
+                        const nx_gfx_rect_t *r) {
+  nx_gfx_sprite_t *sp;
+  nx_gfx_rect_t src;
+
+  nx_gfx_set_clip(back, r);
+  c->background(back, c->arg);
+
+  for (sp = c->sprites; sp != NULL; sp = sp->next) {
+    if (!sp->visible)
+      continue;
+    src.x = 0;
+    src.y = 0;
+    src.w = sp->image->width;
+    src.h = sp->image->height;
+    if (sp->keyed)
+      nx_gfx_blit_key(back, sp->x, sp->y, sp->image, &src, sp->key);
+    else
+      nx_gfx_blit(back, sp->x, sp->y, sp->image, &src);
+  }
+}
+
+U32 nx_gfx_comp_render(nx_gfx_comp_t *c, nx_gfx_surface_t *back) {
+  nx_gfx_rect_t todo[NX_GFX_COMP_MAX_RECTS];
+  nx_gfx_rect_t r;
+  nx_gfx_sprite_t *sp;
+  U32 n, i, pixels = 0;
+
+  /* Collect the regions sprites left and entered. */
+  for (sp = c->sprites; sp != NULL; sp = sp->next) {
+    if (!sp->changed)
+      continue;
+    if (sp->drawn)
+      nx_gfx_comp_invalidate(c, &sp->drawn_rect);
+    if (sp->visible) {
+      sprite_rect(sp, &r);
+      nx_gfx_comp_invalidate(c, &r);
+    }
+  }
+
+  if (c->full_frames > 0) {
+    c->full_frames--;
+    r.x = 0;
+    r.y = 0;
+    r.w = c->width;
+    r.h = c->height;
+    todo[0] = r;
+    n = 1;
+  } else {
+    /* The back buffer also misses the previous frame's changes. */
+    memcpy(todo, c->rects, c->n_rects * sizeof(nx_gfx_rect_t));
+    n = c->n_rects;
+    for (i = 0; i < c->n_prev_rects; i++)
+      add_rect(todo, &n, &c->prev_rects[i]);
+  }
+
+  for (i = 0; i < n; i++) {
+    render_rect(c, back, &todo[i]);
+    pixels += area(&todo[i]);
+  }
+  nx_gfx_set_clip(back, NULL);
+
+  memcpy(c->prev_rects, c->rects, c->n_rects * sizeof(nx_gfx_rect_t));
+  c->n_prev_rects = c->n_rects;
+  c->n_rects = 0;
+
+  for (sp = c->sprites; sp != NULL; sp = sp->next) {
+    sp->changed = FALSE;
+    sp->drawn = sp->visible;
+    if (sp->visible)
+      sprite_rect(sp, &sp->drawn_rect);
+  }
+
+  return pixels;
+}
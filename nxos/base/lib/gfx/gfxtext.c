@@ -0,0 +1,189 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+
+#include "base/lib/gfx/_gfx.h"
+#include "base/lib/gfx/_gfx_font.h"
+
+#if GFX_FONT_WIDTH + 1 != NX_GFX_CHAR_WIDTH || GFX_FONT_HEIGHT != NX_GFX_CHAR_HEIGHT
+#error "The embedded font does not match the text cell size."
+#endif
+
+/* A character cell line is a whole number of pixel pairs. */
+#define CELL_PAIRS (NX_GFX_CHAR_WIDTH / 2)
+
+/* Number of color pairs with expanded glyphs. */
+#define CACHE_SLOTS 4
+
+#define GLYPH_WORDS ((GFX_FONT_GLYPHS + 31) / 32)
+
+/* A cache slot holds the glyphs expanded to pixel pairs for one color
+ * pair. Glyphs are expanded when first drawn.
+ */
+typedef struct {
+  U16 fg, bg;
+  bool valid;
+  U32 last_use;
+  U32 expanded[GLYPH_WORDS];
+  nx__gfx_pair_t pixels[GFX_FONT_GLYPHS][NX_GFX_CHAR_HEIGHT][CELL_PAIRS];
+} glyph_cache_t;
+
+static glyph_cache_t cache[CACHE_SLOTS];
+static U32 cache_clock;
+
+static glyph_cache_t *get_cache(U16 fg, U16 bg) {
+  glyph_cache_t *c, *victim = &cache[0];
+  U32 i;
+
+  cache_clock++;
+  for (i = 0; i < CACHE_SLOTS; i++) {
+    c = &cache[i];
+    if (c->valid && c->fg == fg && c->bg == bg) {
+      c->last_use = cache_clock;
+      return c;
+    }
+    if (!c->valid ||
+        (victim->valid && c->last_use < victim->last_use))
+      victim = c;
+  }
+
+  victim->fg = fg;
+  victim->bg = bg;
+  victim->valid = TRUE;
+  victim->last_use = cache_clock;
+  memset(victim->expanded, 0, sizeof(victim->expanded));
+  return victim;
+}
+
+static inline U32 glyph_index(char ch) {
+  U32 g = (U8)ch - GFX_FONT_START;
+
+  /* Unprintable characters become spaces. */
+  return g < GFX_FONT_GLYPHS ? g : 0;
+}
+
+/* Return the pixel pairs of a glyph, expanding it if needed. */
+static const nx__gfx_pair_t *get_glyph(glyph_cache_t *c, U32 g) {
+  nx__gfx_pair_t (*rows)[CELL_PAIRS] = c->pixels[g];
+  U32 y, p, mask;
+
+  if (!(c->expanded[g / 32] & ((U32)1 << (g % 32)))) {
+    for (y = 0; y < NX_GFX_CHAR_HEIGHT; y++) {
+      mask = gfx_font_data[g][y];
+      for (p = 0; p < CELL_PAIRS; p++, mask >>= 2)
+        rows[y][p] = ((mask & 1) ? c->fg : c->bg) |
+          ((U32)((mask & 2) ? c->fg : c->bg) << 16);
+    }
+    c->expanded[g / 32] |= (U32)1 << (g % 32);
+  }
+
+  return &rows[0][0];
+}
+
+/* Draw an expanded glyph. Cells that are entirely visible are stored a
+ * pixel pair at a time when aligned, else a pixel at a time; clipped
+ * cells are drawn pixel by pixel.
+ */
+static void draw_cell(nx_gfx_surface_t *s, S32 x, S32 y,
+                      const nx__gfx_pair_t *pairs) {
+  U16 *line;
+  const U16 *px;
+  nx__gfx_pair_t *w;
+  S32 i, j;
+
+  if (!nx__gfx_rect_in_clip(s, x, y, NX_GFX_CHAR_WIDTH, NX_GFX_CHAR_HEIGHT)) {
+    for (j = 0; j < NX_GFX_CHAR_HEIGHT; j++, pairs += CELL_PAIRS) {
+      px = (const U16 *)pairs;
+      for (i = 0; i < NX_GFX_CHAR_WIDTH; i++)
+        if (nx__gfx_in_clip(s, x + i, y + j))
+          *nx__gfx_pixel_ptr(s, x + i, y + j) = px[i];
+    }
+    return;
+  }
+
+  line = nx__gfx_pixel_ptr(s, x, y);
+  if (((U32)line & 2) == 0 && (s->stride & 1) == 0) {
+    for (j = 0; j < NX_GFX_CHAR_HEIGHT; j++, pairs += CELL_PAIRS, line += s->stride) {
+      w = (nx__gfx_pair_t *)line;
+      for (i = 0; i < CELL_PAIRS; i++)
+        w[i] = pairs[i];
+    }
+  } else {
+    for (j = 0; j < NX_GFX_CHAR_HEIGHT; j++, pairs += CELL_PAIRS, line += s->stride) {
+      px = (const U16 *)pairs;
+      for (i = 0; i < NX_GFX_CHAR_WIDTH; i++)
+        line[i] = px[i];
+    }
+  }
+}
+
+/* Draw the set pixels of a glyph. */
+static void draw_mask(nx_gfx_surface_t *s, S32 x, S32 y, U32 g, U16 fg) {
+  bool inside = nx__gfx_rect_in_clip(s, x, y, GFX_FONT_WIDTH, GFX_FONT_HEIGHT);
+  U32 mask;
+  S32 i, j;
+
+  for (j = 0; j < GFX_FONT_HEIGHT; j++) {
+    for (mask = gfx_font_data[g][j], i = 0; mask != 0; mask >>= 1, i++)
+      if ((mask & 1) && (inside || nx__gfx_in_clip(s, x + i, y + j)))
+        *nx__gfx_pixel_ptr(s, x + i, y + j) = fg;
+  }
+}
+
+/* Skip the characters of str up to the end of the line. */
+static const char *skip_line(const char *str) {
+  while (*str != '\0' && *str != '\n')
+    str++;
+  return str;
+}
+
+void nx_gfx_text(nx_gfx_surface_t *s, S32 x, S32 y, const char *str,
+                 U16 fg, U16 bg) {
+  glyph_cache_t *c = get_cache(fg, bg);
+  S32 cx = x;
+
+  for (; *str != '\0'; str++) {
+    if (*str == '\n') {
+      cx = x;
+      y += NX_GFX_CHAR_HEIGHT;
+      continue;
+    }
+    /* Nothing more of this line is visible. */
+    if (cx >= s->clip.x + s->clip.w || y >= s->clip.y + s->clip.h ||
+        y + NX_GFX_CHAR_HEIGHT <= s->clip.y) {
+      str = skip_line(str) - 1;
+      continue;
+    }
+    if (cx + NX_GFX_CHAR_WIDTH > s->clip.x)
+      draw_cell(s, cx, y, get_glyph(c, glyph_index(*str)));
+    cx += NX_GFX_CHAR_WIDTH;
+  }
+}
+
+void nx_gfx_text_transparent(nx_gfx_surface_t *s, S32 x, S32 y,
+                             const char *str, U16 fg) {
+  S32 cx = x;
+
+  for (; *str != '\0'; str++) {
+    if (*str == '\n') {
+      cx = x;
+      y += NX_GFX_CHAR_HEIGHT;
+      continue;
+    }
+    if (cx >= s->clip.x + s->clip.w || y >= s->clip.y + s->clip.h ||
+        y + NX_GFX_CHAR_HEIGHT <= s->clip.y) {
+      str = skip_line(str) - 1;
+      continue;
+    }
+    if (cx + NX_GFX_CHAR_WIDTH > s->clip.x)
+      draw_mask(s, cx, y, glyph_index(*str), fg);
+    cx += NX_GFX_CHAR_WIDTH;
+  }
+}
@@ -9,14 +9,81 @@
 #include "base/drivers/sound.h"
 #include "base/lib/gui/gui.h"
 
+#ifdef __DE1SOC__
+#include "base/drivers/button.h"
+
+#define LCD_LINES 60
+#define LCD_COLUMNS 80
+#else
 #define LCD_LINES 8
+#endif
 #define MENU_MAX_HEIGHT (LCD_LINES - 3)
 #define SCROLL_MARKER "    ..."
 
+/* Screen lines of the menu parts. */
+#define TOP_MARKER_LINE 1
+#define FIRST_ENTRY_LINE 2
+
+#ifdef __DE1SOC__
+/* The KEYs, from left to right on the board. */
+#define MENU_BUTTON_PREV BUTTON_3
+#define MENU_BUTTON_NEXT BUTTON_2
+#define MENU_BUTTON_CANCEL BUTTON_1
+#define MENU_BUTTON_OK BUTTON_0
+
+/* Redraw the line of entry i, shown in the window starting at entry
+ * start. The line is padded with blanks up to the given width, so
+ * that whatever the line showed before is wiped.
+ */
+static void draw_entry(gui_text_menu_t *menu, U8 i, U8 start, bool active,
+                       U8 width) {
+  nx_display_cursor_set_pos(0, FIRST_ENTRY_LINE + i - start);
+  nx_display_string(" ");
+  nx_display_uint(i+1);
+  nx_display_string(active ? menu->active_mark : ". ");
+  nx_display_string(menu->entries[i]);
+
+  while (nx_display_cursor_get_pos_x() < width &&
+         nx_display_cursor_get_pos_y() == FIRST_ENTRY_LINE + i - start)
+    nx_display_string(" ");
+}
+
+/* Return the width of the longest entry line of the menu. */
+static U8 lines_width(gui_text_menu_t *menu, U8 count) {
+  U32 width = 0, len, n;
+  U8 i;
+
+  for (i=0; i<count; i++) {
+    len = 1 + MAX(strlen(menu->active_mark), 2) + strlen(menu->entries[i]);
+    for (n = i+1; n > 0; n /= 10)
+      len++;
+    width = MAX(width, len);
+  }
+
+  /* A full line would wrap the cursor to the next one. */
+  return MIN(width, LCD_COLUMNS - 1);
+}
+
+/* Redraw a scroll marker, or wipe it. */
+static void draw_marker(U8 line, bool shown) {
+  nx_display_cursor_set_pos(0, line);
+  nx_display_string(shown ? SCROLL_MARKER : "       ");
+}
+
+/* Return the first entry of the window showing entry current. */
+static U8 window_start(U8 current, U8 count) {
+  if (count > MENU_MAX_HEIGHT && current >= MENU_MAX_HEIGHT)
+    return current - MENU_MAX_HEIGHT + 1;
+  return 0;
+}
+#endif
+
 U8 nx_gui_text_menu(gui_text_menu_t menu) {
   U8 current = 0, count = 0, i;
-#if 0
+#ifdef __DE1SOC__
+  U8 start, end, height, previous, width;
   bool done = FALSE;
+  nx_de1_button_t button;
 #endif
 
   NX_ASSERT(strlen(menu.title) > 0);
@@ -27,75 +94,73 @@ U8 nx_gui_text_menu(gui_text_menu_t menu) {
   if (menu.default_entry < count)
     current = menu.default_entry;
 
-#if 0
-  // FIXME: Update for NxOS-sim
-  do {
-    nx_avr_button_t button;
-    U8 start = 0, end = count;
-
-    nx_display_clear();
-    nx_display_string(menu.title);
-    nx_display_end_line();
-
-    /* Handle menu scrolling. */
-    if (count > MENU_MAX_HEIGHT) {
-      end = MENU_MAX_HEIGHT;
-      if (current >= MENU_MAX_HEIGHT) {
-        start = current - MENU_MAX_HEIGHT + 1;
-        end = current + 1;
-      }
-    }
-
-    /* Display the top scroll marker if needed. */
-    if (start > 0)
-      nx_display_string(SCROLL_MARKER);
-    nx_display_end_line();
-
-    /* Print out menu entries. */
-    for (i=start; i<end; i++) {
-      nx_display_string(" ");
-      nx_display_uint(i+1);
-
-      if (current == i)
-        nx_display_string(menu.active_mark);
-      else
-        nx_display_string(". ");
+#ifdef __DE1SOC__
+  height = MIN(count, MENU_MAX_HEIGHT);
+  width = lines_width(&menu, count);
+
+  /* Draw the whole menu once. From then on, a move only redraws the
+   * lines that change: the previous and new active entries, or the
+   * window and its scroll markers when it scrolls.
+   */
+  start = window_start(current, count);
+  nx_display_begin();
+  nx_display_clear();
+  nx_display_string(menu.title);
+  for (i=start; i<start+height; i++)
+    draw_entry(&menu, i, start, i == current, width);
+  draw_marker(TOP_MARKER_LINE, start > 0);
+  draw_marker(FIRST_ENTRY_LINE + height, start + height < count);
+  nx_display_commit();
+
+  /* Only presses made while the menu is shown count. */
+  nx_de1_button_clear_events();
 
-      nx_display_string(menu.entries[i]);
-      nx_display_end_line();
-    }
-
-    /* Bottom scroll marker. */
-    if (end < count)
-      nx_display_string(SCROLL_MARKER);
-    nx_display_end_line();
-
-    nx_systick_wait_ms(GUI_EVENT_THROTTLE);
-    while ((button = nx_avr_get_button()) == BUTTON_NONE);
+  do {
+    /* Keep the display refreshed while waiting for input. */
+    while ((button = nx_de1_get_button_event()) == BUTTON_NONE)
+      nx_display_flush();
 
+    previous = current;
     switch (button) {
-      case BUTTON_LEFT:
+      case MENU_BUTTON_PREV:
         if (current > 0)
           current--;
         break;
-      case BUTTON_RIGHT:
+      case MENU_BUTTON_NEXT:
         if (current < count-1)
           current++;
         break;
-      case BUTTON_OK:
+      case MENU_BUTTON_OK:
         done = TRUE;
         break;
-      case BUTTON_CANCEL:
-    	  nx_sound_freq(1000, 100);
-    	  nx_systick_wait_ms(50);
-    	  break;
+      case MENU_BUTTON_CANCEL:
+        nx_sound_freq_async(1000, 100);
+        break;
       default:
         break;
     }
+
+    if (current == previous)
+      continue;
+
+    nx_display_begin();
+    if (window_start(current, count) != start) {
+      start = window_start(current, count);
+      end = start + height;
+      for (i=start; i<end; i++)
+        draw_entry(&menu, i, start, i == current, width);
+      draw_marker(TOP_MARKER_LINE, start > 0);
+      draw_marker(FIRST_ENTRY_LINE + height, end < count);
+    } else {
+      draw_entry(&menu, previous, start, FALSE, width);
+      draw_entry(&menu, current, start, TRUE, width);
+    }
+    nx_display_commit();
   } while (!done);
+#else
+  // FIXME: Update for the NXT buttons
 #endif
 
-  nx_systick_wait_ms(GUI_EVENT_AVOID_REPEAT);
   return current;
 }
 
@@ -27,14 +27,6 @@
  */
 /*@{*/
 
-/** Wait time in milliseconds before next event polling. */
-#define GUI_EVENT_THROTTLE 350
-
-/** Wait time in milliseconds after a menu entry was selected
- * to avoid stroke repeat.
- */
-#define GUI_EVENT_AVOID_REPEAT 300
-
 /** Default menu marker for active entry. */
 #define GUI_DEFAULT_TEXT_MARK "> "
 
@@ -48,6 +40,11 @@ typedef struct gui_text_menu {
 } gui_text_menu_t;
 
 /** Display the text menu described by @a menu.
+ *
+ * On the DE1-SoC, KEY3 and KEY2 move to the previous and next entries,
+ * KEY0 selects the active entry and KEY1 beeps. The menu reacts to
+ * each key press as it is made: only the lines that change are
+ * redrawn.
  *
  * @param menu A @a gui_text_menu_t structure describing the menu.
  * @return The choosen entry number.
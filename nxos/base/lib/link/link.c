@@ -0,0 +1,376 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/drivers/systick.h"
+#include "base/drivers/uart.h"
+
+#include "base/lib/link/link.h"
+
+#ifdef __DE1SOC__
+
+#define HEADER_SIZE 4
+#define CRC_SIZE 4
+#define MAX_PACKET (HEADER_SIZE + NX_LINK_MTU + CRC_SIZE)
+#define MAX_ENCODED NX_LINK_COBS_SIZE(MAX_PACKET)
+
+/* Sequence numbers are 8 bits wide: the window slots must wrap with
+ * them.
+ */
+#if (256 % NX_LINK_WINDOW) != 0
+#error "NX_LINK_WINDOW must divide 256"
+#endif
+
+typedef struct {
+  U8 port;
+  U16 len;
+  U8 data[NX_LINK_MTU];
+} packet_t;
+
+static struct {
+  nx_uart_port_t uart;
+
+  /* Reliable packets sent, from tx_base to tx_next excluded, kept for
+   * retransmission until acknowledged. tx_timer is when the oldest
+   * was last sent.
+   */
+  packet_t window[NX_LINK_WINDOW];
+  U8 tx_base, tx_next;
+  U32 tx_timer;
+
+  /* Next reliable sequence number expected, and the received packets
+   * waiting for nx_link_recv().
+   */
+  U8 rx_expected;
+  packet_t rx_slots[NX_LINK_RX_SLOTS];
+  U32 rx_head, rx_tail;
+
+  /* The frame being received, still encoded. */
+  U8 frame[MAX_ENCODED];
+  U32 frame_len;
+  bool frame_overflow;
+
+  /* Scratch buffers for the decoded and encoded packets. */
+  U8 packet[MAX_PACKET];
+  U8 encoded[MAX_ENCODED + 1];
+
+  nx_link_stats_t stats;
+} link;
+
+/* CRC-32 table, four bits at a time. */
+static const U32 crc_table[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+  0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+  0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+U32 nx_link_crc32(const void *buf, U32 len) {
+  const U8 *p = buf;
+  U32 crc = 0xFFFFFFFF;
+
+  while (len-- > 0) {
+    crc ^= *p++;
+    crc = (crc >> 4) ^ crc_table[crc & 0xF];
+    crc = (crc >> 4) ^ crc_table[crc & 0xF];
+  }
+
+  return ~crc;
+}
+
+U32 nx_link_cobs_encode(const U8 *in, U32 len, U8 *out) {
+  U32 code_pos = 0, n = 1, i;
+  U8 code = 1;
+
+  for (i = 0; i < len; i++) {
+    if (in[i] == 0) {
+      out[code_pos] = code;
+      code_pos = n++;
+      code = 1;
+    } else {
+      out[n++] = in[i];
+      if (++code == 0xFF) {
+        out[code_pos] = code;
+        code_pos = n++;
+        code = 1;
+      }
+    }
+  }
+  out[code_pos] = code;
+
+  return n;
+}
+
+/* COBS decode len bytes of in, and return the decoded size, or -1 if
+ * the encoding is invalid or the result larger than size.
+ */
+static S32 cobs_decode(const U8 *in, U32 len, U8 *out, U32 size) {
+  U32 i = 0, n = 0, j;
+  U8 code;
+
+  while (i < len) {
+    code = in[i++];
+    if (code == 0)
+      return -1;
+    for (j = 1; j < code; j++) {
+      if (i >= len || n >= size)
+        return -1;
+      out[n++] = in[i++];
+    }
+    /* Blocks shorter than the maximum stand for a zero, except at the
+     * end.
+     */
+    if (code != 0xFF && i < len) {
+      if (n >= size)
+        return -1;
+      out[n++] = 0;
+    }
+  }
+
+  return n;
+}
+
+static void send_packet(U8 type, U8 flags, U8 seq, U8 port,
+                        const U8 *data, U32 len) {
+  U32 crc, n;
+
+  link.packet[0] = type;
+  link.packet[1] = flags;
+  link.packet[2] = seq;
+  link.packet[3] = port;
+  memcpy(&link.packet[HEADER_SIZE], data, len);
+  len += HEADER_SIZE;
+
+  crc = nx_link_crc32(link.packet, len);
+  link.packet[len++] = crc;
+  link.packet[len++] = crc >> 8;
+  link.packet[len++] = crc >> 16;
+  link.packet[len++] = crc >> 24;
+
+  n = nx_link_cobs_encode(link.packet, len, link.encoded);
+  link.encoded[n++] = 0;
+  nx_uart_port_writebuf(link.uart, link.encoded, n);
+}
+
+static void send_reliable(U8 seq) {
+  packet_t *p = &link.window[seq % NX_LINK_WINDOW];
+
+  send_packet(NX_LINK_DATA, NX_LINK_RELIABLE, seq, p->port, p->data, p->len);
+}
+
+/* Queue a received payload for nx_link_recv(), if there is room. */
+static bool deliver(U8 port, const U8 *data, U32 len) {
+  packet_t *p;
+
+  if (link.rx_head - link.rx_tail >= NX_LINK_RX_SLOTS)
+    return FALSE;
+
+  p = &link.rx_slots[link.rx_head % NX_LINK_RX_SLOTS];
+  p->port = port;
+  p->len = len;
+  memcpy(p->data, data, len);
+  link.rx_head++;
+  link.stats.rx_packets++;
+
+  return TRUE;
+}
+
+static void handle_data(U8 flags, U8 seq, U8 port, const U8 *data, U32 len) {
+  if (!(flags & NX_LINK_RELIABLE)) {
+    if (!deliver(port, data, len))
+      link.stats.rx_dropped++;
+    return;
+  }
+
+  /* Without room, the packet is not acknowledged: the sender tries
+   * again later.
+   */
+  if (seq == link.rx_expected && deliver(port, data, len)) {
+    link.rx_expected++;
+    send_packet(NX_LINK_ACK, 0, seq, 0, NULL, 0);
+    return;
+  }
+
+  /* Out of sequence, a duplicate, or no room: acknowledge the last
+   * packet taken again, in case that acknowledgement was lost.
+   */
+  link.stats.rx_dropped++;
+  send_packet(NX_LINK_ACK, 0, link.rx_expected - 1, 0, NULL, 0);
+}
+
+static void handle_ack(U8 seq) {
+  U8 outstanding = link.tx_next - link.tx_base;
+
+  /* Acknowledgements are cumulative. */
+  if ((U8)(seq - link.tx_base) < outstanding) {
+    link.tx_base = seq + 1;
+    link.tx_timer = nx_systick_get_ms();
+  }
+}
+
+static void handle_sync(U8 flags, U8 seq) {
+  link.rx_expected = seq;
+
+  if (!(flags & NX_LINK_REPLY)) {
+    /* The peer starts over: so do we, dropping what it did not
+     * acknowledge.
+     */
+    link.tx_base = link.tx_next = 0;
+    send_packet(NX_LINK_SYNC, NX_LINK_REPLY, link.tx_next, 0, NULL, 0);
+  }
+}
+
+static void handle_frame(void) {
+  S32 len;
+  U32 crc;
+  U8 *p = link.packet;
+
+  len = cobs_decode(link.frame, link.frame_len, p, MAX_PACKET);
+  if (len < HEADER_SIZE + CRC_SIZE) {
+    link.stats.frame_errors++;
+    return;
+  }
+
+  len -= CRC_SIZE;
+  crc = p[len] | (p[len + 1] << 8) | (p[len + 2] << 16) | ((U32)p[len + 3] << 24);
+  if (crc != nx_link_crc32(p, len)) {
+    link.stats.crc_errors++;
+    return;
+  }
+
+  switch (p[0]) {
+    case NX_LINK_DATA:
+      handle_data(p[1], p[2], p[3], &p[HEADER_SIZE], len - HEADER_SIZE);
+      break;
+    case NX_LINK_ACK:
+      handle_ack(p[2]);
+      break;
+    case NX_LINK_SYNC:
+      handle_sync(p[1], p[2]);
+      break;
+    default:
+      link.stats.frame_errors++;
+      break;
+  }
+}
+
+static void receive_byte(U8 c) {
+  if (c != 0) {
+    if (link.frame_len < MAX_ENCODED)
+      link.frame[link.frame_len++] = c;
+    else
+      link.frame_overflow = TRUE;
+    return;
+  }
+
+  if (link.frame_overflow)
+    link.stats.frame_errors++;
+  else if (link.frame_len > 0)
+    handle_frame();
+
+  link.frame_len = 0;
+  link.frame_overflow = FALSE;
+}
+
+void nx_link_init(nx_uart_port_t uart) {
+  memset(&link, 0, sizeof(link));
+  link.uart = uart;
+}
+
+void nx_link_poll(void) {
+  U8 buf[UART_RXBUFSIZE];
+  U32 n, i;
+  U8 seq;
+
+  while ((n = nx_uart_port_read(link.uart, buf, sizeof(buf))) > 0) {
+    for (i = 0; i < n; i++)
+      receive_byte(buf[i]);
+  }
+
+  if (link.tx_base != link.tx_next &&
+      nx_systick_get_ms() - link.tx_timer >= NX_LINK_RTO_MS) {
+    /* Go back N: resend everything from the oldest packet on. */
+    for (seq = link.tx_base; seq != link.tx_next; seq++) {
+      send_reliable(seq);
+      link.stats.retransmits++;
+    }
+    link.tx_timer = nx_systick_get_ms();
+  }
+}
+
+bool nx_link_send(U8 port, const void *data, U32 len, bool reliable) {
+  packet_t *p;
+
+  if (len > NX_LINK_MTU)
+    return FALSE;
+
+  link.stats.tx_packets++;
+
+  if (!reliable) {
+    send_packet(NX_LINK_DATA, 0, 0, port, data, len);
+    return TRUE;
+  }
+
+  while ((U8)(link.tx_next - link.tx_base) >= NX_LINK_WINDOW)
+    nx_link_poll();
+
+  p = &link.window[link.tx_next % NX_LINK_WINDOW];
+  p->port = port;
+  p->len = len;
+  memcpy(p->data, data, len);
+
+  if (link.tx_base == link.tx_next)
+    link.tx_timer = nx_systick_get_ms();
+  send_reliable(link.tx_next++);
+
+  return TRUE;
+}
+
+bool nx_link_ready(U32 len, bool reliable) {
+  if (reliable && (U8)(link.tx_next - link.tx_base) >= NX_LINK_WINDOW)
+    return FALSE;
+
+  /* The frame and its delimiter. */
+  return nx_uart_port_write_avail(link.uart) >=
+    NX_LINK_COBS_SIZE(HEADER_SIZE + len + CRC_SIZE) + 1;
+}
+
+S32 nx_link_recv(U8 *port, void *buf, U32 size) {
+  packet_t *p;
+  U32 len;
+
+  if (link.rx_head == link.rx_tail)
+    return -1;
+
+  p = &link.rx_slots[link.rx_tail % NX_LINK_RX_SLOTS];
+  len = MIN(size, p->len);
+  *port = p->port;
+  memcpy(buf, p->data, len);
+  link.rx_tail++;
+
+  return len;
+}
+
+bool nx_link_flush(U32 timeout_ms) {
+  U32 start = nx_systick_get_ms();
+
+  while (link.tx_base != link.tx_next) {
+    if (nx_systick_get_ms() - start >= timeout_ms)
+      return FALSE;
+    nx_link_poll();
+  }
+
+  return TRUE;
+}
+
+void nx_link_get_stats(nx_link_stats_t *stats) {
+  memcpy(stats, &link.stats, sizeof(*stats));
+}
+
+#endif /* __DE1SOC__ */
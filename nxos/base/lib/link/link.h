@@ -0,0 +1,171 @@
+/** @file link.h
+ *  @brief Framed packet transport over the UART.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_LIB_LINK_H__
+#define __NXOS_BASE_LIB_LINK_H__
+
+#include "base/types.h"
+#include "base/drivers/uart.h"
+
+#ifdef __DE1SOC__
+
+/** @addtogroup lib */
+/*@{*/
+
+/** @defgroup link Packet link
+ *
+ * Binary packets exchanged with a host over a JTAG UART, for moving
+ * test vectors and captured buffers without going through text dumps.
+ * @c scripts/nxlink.py is the host side.
+ *
+ * Each packet is sent as a frame: the packet, followed by its CRC-32
+ * (little endian), COBS encoded and terminated by a zero byte. A
+ * corrupted frame is dropped, and the receiver resynchronizes on the
+ * next zero byte. Packets start with a 4 byte header:
+ *
+ * - The type: @c NX_LINK_DATA, @c NX_LINK_ACK or @c NX_LINK_SYNC.
+ * - Flags: @c NX_LINK_RELIABLE for packets to acknowledge, and
+ *   @c NX_LINK_REPLY for the answer to a SYNC.
+ * - The sequence number of the packet, or the acknowledged one.
+ * - The port, which tells the application streams apart.
+ *
+ * and carry up to @c NX_LINK_MTU bytes of payload.
+ *
+ * Reliable packets are numbered, acknowledged and retransmitted with a
+ * go-back-N sliding window of @c NX_LINK_WINDOW packets: the receiver
+ * only takes the next packet in sequence, and acknowledges the last
+ * one it took. The sender resends all the unacknowledged packets when
+ * the oldest one has not been acknowledged for @c NX_LINK_RTO_MS.
+ * Unreliable packets are delivered if they arrive intact, and dropped
+ * otherwise.
+ *
+ * A SYNC packet restarts the sequence numbers of both sides: the host
+ * sends one when it connects.
+ *
+ * The link does its work in nx_link_poll(), which the application
+ * must call regularly; the other routines call it while they wait.
+ */
+/*@{*/
+
+#define NX_LINK_MTU 256 /**< Maximum payload size. */
+#define NX_LINK_WINDOW 4 /**< Reliable packets sent ahead of acknowledgements. */
+#define NX_LINK_RX_SLOTS 4 /**< Received packets waiting for nx_link_recv(). */
+#define NX_LINK_RTO_MS 200 /**< Retransmission timeout. */
+
+/** @name Packet types and flags */
+/*@{*/
+#define NX_LINK_DATA 0x01 /**< Application data. */
+#define NX_LINK_ACK 0x02 /**< Acknowledgement of a reliable packet. */
+#define NX_LINK_SYNC 0x03 /**< Sequence number restart. */
+
+#define NX_LINK_RELIABLE 0x01 /**< The packet must be acknowledged. */
+#define NX_LINK_REPLY 0x02 /**< The SYNC answers another one. */
+/*@}*/
+
+/** @brief Link statistics. */
+typedef struct {
+  U32 tx_packets;     /**< Data packets sent, retransmissions excluded. */
+  U32 rx_packets;     /**< Data packets delivered. */
+  U32 retransmits;    /**< Packets sent again after a timeout. */
+  U32 crc_errors;     /**< Frames dropped for a bad checksum. */
+  U32 frame_errors;   /**< Frames dropped for a bad encoding or size. */
+  U32 rx_dropped;     /**< Packets dropped, out of sequence or for lack of room. */
+} nx_link_stats_t;
+
+/** Initialize the link.
+ *
+ * @param uart The UART port to run the link on.
+ */
+void nx_link_init(nx_uart_port_t uart);
+
+/** Process the received frames and the retransmission timer. */
+void nx_link_poll(void);
+
+/** Send a packet.
+ *
+ * A reliable packet is queued in the window for retransmission: if the
+ * window is full, this waits for an acknowledgement.
+ *
+ * @param port The port of the packet.
+ * @param data The payload.
+ * @param len The payload size, at most @c NX_LINK_MTU.
+ * @param reliable Whether the packet must be acknowledged.
+ * @return FALSE if the payload is too large.
+ */
+bool nx_link_send(U8 port, const void *data, U32 len, bool reliable);
+
+/** Check whether a packet can be sent without waiting.
+ *
+ * That is, whether the window has room for a reliable packet, and the
+ * UART transmit ring for the whole frame.
+ *
+ * @param len The payload size.
+ * @param reliable Whether the packet must be acknowledged.
+ * @return TRUE if nx_link_send() would not block.
+ */
+bool nx_link_ready(U32 len, bool reliable);
+
+/** Take the next received packet.
+ *
+ * This routine is non-blocking.
+ *
+ * @param port Where to store the port of the packet.
+ * @param buf The buffer for the payload.
+ * @param size The size of @a buf. Longer payloads are truncated.
+ * @return The payload size, or -1 if no packet was received.
+ */
+S32 nx_link_recv(U8 *port, void *buf, U32 size);
+
+/** Wait until all the reliable packets sent are acknowledged.
+ *
+ * @param timeout_ms The maximum time to wait.
+ * @return TRUE if they are, FALSE on timeout.
+ */
+bool nx_link_flush(U32 timeout_ms);
+
+/** Get the link statistics.
+ *
+ * @param stats The structure to fill.
+ */
+void nx_link_get_stats(nx_link_stats_t *stats);
+
+/** The size of @a n bytes once COBS encoded, without the delimiter:
+ * one code byte per 254 bytes, plus the first.
+ */
+#define NX_LINK_COBS_SIZE(n) ((n) + (n) / 254 + 1)
+
+/** COBS encode @a len bytes of @a in, as in the frames of the link.
+ *
+ * Other byte streams that share the frame format, such as the binary
+ * log, use it too.
+ *
+ * @param in The data.
+ * @param len The size of the data.
+ * @param out The buffer for the encoded bytes, at least
+ * NX_LINK_COBS_SIZE(@a len) bytes. The zero delimiter is not added.
+ * @return The encoded size.
+ */
+U32 nx_link_cobs_encode(const U8 *in, U32 len, U8 *out);
+
+/** Compute the CRC-32 (IEEE 802.3) of @a len bytes of @a buf.
+ *
+ * @param buf The data.
+ * @param len The size of the data.
+ * @return The CRC, as computed by zlib's crc32().
+ */
+U32 nx_link_crc32(const void *buf, U32 len);
+
+/*@}*/
+/*@}*/
+
+#endif /* __DE1SOC__ */
+#endif /* __NXOS_BASE_LIB_LINK_H__ */
@@ -0,0 +1,324 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include <stdarg.h>
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/format.h"
+#include "base/display.h"
+#include "base/interrupts.h"
+#include "base/drivers/systick.h"
+#include "base/drivers/uart.h"
+#include "base/lib/link/link.h"
+
+#include "base/lib/log/log.h"
+
+#ifdef __DE1SOC__
+
+#if (NX_LOG_RECORDS & (NX_LOG_RECORDS - 1)) != 0
+#error "NX_LOG_RECORDS must be a power of 2"
+#endif
+
+/* Orders the stores to a record before its commit, for the compiler:
+ * the writers and the flusher share a single core.
+ */
+#define BARRIER() asm volatile("" : : : "memory")
+
+/* The longest line written: time, level and message. */
+#define LINE_SIZE (16 + NX_LOG_TEXT)
+
+/* The largest binary frame: the id, the time delta, the level or the
+ * arguments, and the text, then COBS and the delimiter.
+ */
+#define FRAME_SIZE (2 + 5 + 1 + NX_LOG_TEXT)
+#define ENCODED_SIZE (NX_LINK_COBS_SIZE(FRAME_SIZE) + 1)
+
+/* A record is committed when its seq is one more than its index in
+ * the ring: the flusher stops at the first record still being written.
+ * Records with an id other than NX_LOG_ID_TEXT come from NX_LOG()
+ * call sites in binary mode, and hold arguments instead of text.
+ */
+typedef struct {
+  volatile U32 seq;
+  U32 time;
+  U16 id;
+  U8 level;
+  U8 nargs;
+  union {
+    char text[NX_LOG_TEXT];
+    U32 args[NX_LOG_MAX_ARGS];
+  } u;
+} record_t;
+
+static struct {
+  record_t records[NX_LOG_RECORDS];
+
+  /* Free running indices: head is the next record to reserve, tail
+   * the next to write out.
+   */
+  volatile U32 head;
+  volatile U32 tail;
+
+  volatile nx_log_level_t level;
+  U32 sinks;
+
+  volatile nx_log_stats_t stats;
+
+  /* Dropped records already reported by the flusher. */
+  U32 reported;
+
+  /* Time of the last binary frame, for the deltas. */
+  U32 last_time;
+} klog;
+
+static const char level_names[] = "EWID";
+
+void nx_log_init(void) {
+  memset((void *)&klog, 0, sizeof(klog));
+  klog.level = NX_LOG_INFO;
+#ifdef __LOGBINARY__
+  klog.sinks = NX_LOG_SINK_BINARY;
+#else
+  klog.sinks = NX_LOG_SINK_UART;
+#endif
+  nx_systick_install_idle(nx_log_flush);
+}
+
+/* Reserve a record, or return NULL if the message is filtered out or
+ * the ring is full. Only the reservation is done with interrupts
+ * masked: interrupt handlers may log while a record is being filled.
+ */
+static record_t *reserve(nx_log_level_t level, U32 *seq) {
+  record_t *r;
+  U32 head, state;
+
+  state = nx_interrupts_save();
+  if (level > klog.level) {
+    klog.stats.filtered++;
+    nx_interrupts_restore(state);
+    return NULL;
+  }
+  head = klog.head;
+  if (head - klog.tail >= NX_LOG_RECORDS) {
+    klog.stats.dropped++;
+    nx_interrupts_restore(state);
+    return NULL;
+  }
+  klog.head = head + 1;
+  klog.stats.logged++;
+
+  /* Taken with the reservation, so that times follow the ring order. */
+  r = &klog.records[head & (NX_LOG_RECORDS - 1)];
+  r->time = nx_systick_get_ms();
+  nx_interrupts_restore(state);
+
+  r->level = level;
+  *seq = head + 1;
+  return r;
+}
+
+static inline void commit(record_t *r, U32 seq) {
+  BARRIER();
+  r->seq = seq;
+}
+
+void nx_log(nx_log_level_t level, const char *fmt, ...) {
+  record_t *r;
+  va_list ap;
+  U32 seq;
+
+  if ((r = reserve(level, &seq)) == NULL)
+    return;
+
+  r->id = NX_LOG_ID_TEXT;
+  va_start(ap, fmt);
+  nx_vsnprintf(r->u.text, NX_LOG_TEXT, fmt, ap);
+  va_end(ap);
+  commit(r, seq);
+}
+
+void nx__log_binary(nx_log_level_t level, U32 id, U32 nargs, ...) {
+  record_t *r;
+  va_list ap;
+  U32 seq, i;
+
+  if ((r = reserve(level, &seq)) == NULL)
+    return;
+
+  r->id = id;
+  r->nargs = nargs;
+  va_start(ap, nargs);
+  for (i = 0; i < nargs; i++)
+    r->u.args[i] = va_arg(ap, U32);
+  va_end(ap);
+  commit(r, seq);
+}
+
+void nx_log_set_level(nx_log_level_t level) {
+  klog.level = level;
+}
+
+nx_log_level_t nx_log_get_level(void) {
+  return klog.level;
+}
+
+void nx_log_set_sinks(U32 sinks) {
+  /* Both write to the UART. */
+  if (sinks & NX_LOG_SINK_BINARY)
+    sinks &= ~NX_LOG_SINK_UART;
+  klog.sinks = sinks;
+}
+
+/* Write a line to the text sinks, unless the UART cannot take it now. */
+static bool write_line(const char *line, U32 len) {
+  if ((klog.sinks & NX_LOG_SINK_UART) && nx_uart_write_avail() < len)
+    return FALSE;
+
+  if (klog.sinks & NX_LOG_SINK_UART)
+    nx_uart_write((const U8 *)line, len);
+  if (klog.sinks & NX_LOG_SINK_DISPLAY)
+    nx_display_string(line);
+  return TRUE;
+}
+
+/* Format a record as text. Binary records have no format string on
+ * the target: their id and arguments are printed instead.
+ */
+static U32 format_line(const record_t *r, char *line) {
+  U32 len, i;
+
+  len = nx_snprintf(line, LINE_SIZE, "[%6lu.%03lu] %c ",
+                    r->time / 1000, r->time % 1000, level_names[r->level]);
+  if (r->id == NX_LOG_ID_TEXT) {
+    len += nx_snprintf(line + len, LINE_SIZE - len, "%s", r->u.text);
+  } else {
+    len += nx_snprintf(line + len, LINE_SIZE - len, "#%u", r->id);
+    for (i = 0; i < r->nargs && len < LINE_SIZE; i++)
+      len += nx_snprintf(line + len, LINE_SIZE - len, " %lx", r->u.args[i]);
+  }
+  len = MIN(len, LINE_SIZE - 2);
+  line[len++] = '\n';
+  line[len] = '\0';
+  return len;
+}
+
+static U8 *put_varint(U8 *p, U32 v) {
+  while (v >= 0x80) {
+    *p++ = v | 0x80;
+    v >>= 7;
+  }
+  *p++ = v;
+  return p;
+}
+
+/* Write a binary frame to the UART, unless it cannot take it now. */
+static bool write_frame(const U8 *frame, U32 len) {
+  U8 encoded[ENCODED_SIZE];
+  U32 n;
+
+  n = nx_link_cobs_encode(frame, len, encoded);
+  encoded[n++] = 0;
+  if (nx_uart_write_avail() < n)
+    return FALSE;
+  nx_uart_write(encoded, n);
+  return TRUE;
+}
+
+/* Encode a record in binary: id and time delta, then the level and
+ * text of text records, or the arguments.
+ */
+static U32 format_frame(const record_t *r, U8 *frame) {
+  U8 *p = frame;
+  U32 i, len;
+
+  *p++ = r->id;
+  *p++ = r->id >> 8;
+  p = put_varint(p, r->time - klog.last_time);
+  if (r->id == NX_LOG_ID_TEXT) {
+    *p++ = r->level;
+    len = strlen(r->u.text);
+    memcpy(p, r->u.text, len);
+    p += len;
+  } else {
+    for (i = 0; i < r->nargs; i++)
+      p = put_varint(p, r->u.args[i]);
+  }
+  return p - frame;
+}
+
+static bool report_drops(U32 dropped) {
+  char line[LINE_SIZE];
+  U8 frame[FRAME_SIZE], *p = frame;
+  U32 len;
+
+  if (klog.sinks & NX_LOG_SINK_BINARY) {
+    *p++ = (U8)NX_LOG_ID_DROPPED;
+    *p++ = NX_LOG_ID_DROPPED >> 8;
+    p = put_varint(p, dropped);
+    if (!write_frame(frame, p - frame))
+      return FALSE;
+  }
+  if (klog.sinks & (NX_LOG_SINK_UART | NX_LOG_SINK_DISPLAY)) {
+    len = nx_snprintf(line, sizeof(line), "[log] %lu records dropped\n",
+                      dropped);
+    if (!write_line(line, MIN(len, sizeof(line) - 1)))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+void nx_log_flush(void) {
+  char line[LINE_SIZE];
+  U8 frame[FRAME_SIZE];
+  record_t *r;
+  U32 tail, dropped, len, n;
+
+  if (klog.sinks == 0)
+    return;
+
+  dropped = klog.stats.dropped;
+  if (dropped != klog.reported) {
+    if (!report_drops(dropped - klog.reported))
+      return;
+    klog.reported = dropped;
+  }
+
+  for (n = 0; n < NX_LOG_FLUSH_RECORDS; n++) {
+    tail = klog.tail;
+    r = &klog.records[tail & (NX_LOG_RECORDS - 1)];
+    if (r->seq != tail + 1)
+      break;
+
+    if (klog.sinks & NX_LOG_SINK_BINARY) {
+      if (!write_frame(frame, format_frame(r, frame)))
+        break;
+      klog.last_time = r->time;
+    }
+    if (klog.sinks & (NX_LOG_SINK_UART | NX_LOG_SINK_DISPLAY)) {
+      len = format_line(r, line);
+      if (!write_line(line, len))
+        break;
+    }
+
+    /* Release the record to the writers. */
+    BARRIER();
+    klog.tail = tail + 1;
+    klog.stats.written++;
+  }
+}
+
+U32 nx_log_get_pending(void) {
+  return klog.head - klog.tail;
+}
+
+void nx_log_get_stats(nx_log_stats_t *stats) {
+  memcpy(stats, (const void *)&klog.stats, sizeof(*stats));
+}
+
+#endif /* __DE1SOC__ */
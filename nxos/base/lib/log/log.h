@@ -0,0 +1,197 @@
+/** @file log.h
+ *  @brief Deferred kernel log.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_LIB_LOG_H__
+#define __NXOS_BASE_LIB_LOG_H__
+
+#include "base/types.h"
+
+#ifdef __DE1SOC__
+
+/** @addtogroup lib */
+/*@{*/
+
+/** @defgroup log Kernel log
+ *
+ * Diagnostic messages that do not disturb the timing of the code that
+ * emits them. nx_log() only formats the message into a record of an
+ * in-memory ring, along with the time and the level, and returns: it
+ * never waits, and may be called from interrupt handlers.
+ *
+ * The records are written out later by nx_log_flush(), which
+ * nx_log_init() adds to the idle callbacks (see
+ * nx_systick_install_idle()): whenever the application waits, or
+ * calls nx_systick_idle(). Each flush writes a bounded number of
+ * records, and only as many as the UART transmit ring takes without
+ * waiting.
+ *
+ * Only the reservation of a record masks interrupts, for a few
+ * instructions, so nx_log() works with interrupts enabled or not.
+ * When the ring is full, records are dropped and counted, and the
+ * next flush reports how many.
+ *
+ * @note The UART sinks write to the first UART: turn them off while it
+ * carries the packet link (see link.h).
+ *
+ * @section binary Binary mode
+ *
+ * Messages logged with the NX_LOG() macro can be recorded in binary
+ * instead: build with @c LOGBIN=1 (which defines @c __LOGBINARY__).
+ * Each call site then describes itself in the @c .nxlog.fmt section of
+ * the ELF file: level, argument count, line, format string and source
+ * file. The linker scripts do not load that section, so the strings
+ * take no room in the image. The record only keeps the offset of the
+ * description, the call site id, and the raw arguments.
+ *
+ * The binary sink, the default in binary mode, writes each record as
+ * a COBS frame terminated by a zero byte. The frame contains the call
+ * site id (16 bits, little endian) and the time since the previous
+ * frame in milliseconds. The arguments follow as base 128 varints.
+ * Records of nx_log() carry the level and the text instead, under the
+ * id @c NX_LOG_ID_TEXT. Drop reports have the id @c NX_LOG_ID_DROPPED
+ * and carry the number of records dropped. @c scripts/nxlog.py
+ * rebuilds the text from the ELF file.
+ *
+ * The arguments of binary call sites must be 32 bit integers or
+ * pointers. A @c %%s argument is printed by the host only if it points
+ * to a string constant of the image.
+ */
+/*@{*/
+
+#define NX_LOG_RECORDS 64 /**< Records in the ring, a power of 2. */
+#define NX_LOG_TEXT 56 /**< Maximum message length, longer ones are truncated. */
+#define NX_LOG_FLUSH_RECORDS 8 /**< Records written by a flush, at most. */
+#define NX_LOG_MAX_ARGS 6 /**< Arguments of a binary call site, at most. */
+
+#define NX_LOG_ID_TEXT 0xFFFF /**< Binary id of nx_log() records. */
+#define NX_LOG_ID_DROPPED 0xFFFE /**< Binary id of drop reports. */
+
+/** @brief Log levels, by decreasing severity. */
+typedef enum {
+  NX_LOG_ERROR = 0, /**< Something failed. */
+  NX_LOG_WARN,      /**< Something unexpected happened. */
+  NX_LOG_INFO,      /**< Normal operation. */
+  NX_LOG_DEBUG,     /**< Details for debugging. */
+} nx_log_level_t;
+
+/** @name Sinks */
+/*@{*/
+#define NX_LOG_SINK_UART 0x01 /**< The first UART. */
+#define NX_LOG_SINK_DISPLAY 0x02 /**< The text display. */
+#define NX_LOG_SINK_BINARY 0x04 /**< Binary frames on the first UART, instead of text. */
+/*@}*/
+
+/** @brief Log statistics. */
+typedef struct {
+  U32 logged;   /**< Records stored. */
+  U32 dropped;  /**< Records dropped, the ring being full. */
+  U32 filtered; /**< Messages below the level filter. */
+  U32 written;  /**< Records written to the sinks. */
+} nx_log_stats_t;
+
+/** Initialize the log, and add nx_log_flush() to the idle callbacks.
+ *
+ * The level filter starts at @c NX_LOG_INFO, and the sink is the UART,
+ * in text or binary depending on the mode.
+ */
+void nx_log_init(void);
+
+/** Log a message.
+ *
+ * This routine never blocks, and may be called from interrupt
+ * handlers.
+ *
+ * @param level The level of the message. It is ignored if less severe
+ * than the level filter.
+ * @param fmt The format string, see nx_snprintf().
+ */
+void nx_log(nx_log_level_t level, const char *fmt, ...)
+  __attribute__((format(printf, 2, 3)));
+
+/** @cond INTERNAL */
+void nx__log_binary(nx_log_level_t level, U32 id, U32 nargs, ...);
+
+static inline void nx__log_check(const char *fmt, ...)
+  __attribute__((format(printf, 1, 2)));
+static inline void nx__log_check(const char *fmt __attribute__((unused)),
+                                 ...) {
+}
+
+#define NX__LOG_NARGS(...) NX__LOG_NARGS_(_, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define NX__LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, n, ...) n
+/** @endcond */
+
+#ifdef __LOGBINARY__
+/** Log a message, in binary in binary mode.
+ *
+ * In text mode, this is nx_log(). In binary mode, @a fmt is only kept
+ * in the @c .nxlog.fmt section (see @ref binary).
+ *
+ * @param level The level of the message, a constant.
+ * @param fmt The format string, a literal.
+ */
+#define NX_LOG(level, fmt, ...) do {                                    \
+    static const struct {                                               \
+      U8 lv;                                                            \
+      U8 nargs;                                                         \
+      U16 line;                                                         \
+      char format[sizeof(fmt)];                                         \
+      char file[sizeof(__FILE__)];                                      \
+    } __attribute__((packed)) nx__log_site                              \
+      __attribute__((section(".nxlog.fmt"), used)) = {                  \
+      level, NX__LOG_NARGS(__VA_ARGS__), __LINE__, fmt, __FILE__        \
+    };                                                                  \
+    if (0)                                                              \
+      nx__log_check(fmt, ##__VA_ARGS__);                                \
+    nx__log_binary(level, (U32)&nx__log_site,                           \
+                   NX__LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__);          \
+  } while (0)
+#else
+#define NX_LOG(level, fmt, ...) nx_log(level, fmt, ##__VA_ARGS__)
+#endif
+
+/** Set the level filter.
+ *
+ * @param level The least severe level logged.
+ */
+void nx_log_set_level(nx_log_level_t level);
+
+/** Return the level filter. */
+nx_log_level_t nx_log_get_level(void);
+
+/** Set where the records are written.
+ *
+ * @param sinks A combination of the sinks, or 0 to keep the records in
+ * the ring. The binary sink takes precedence over the UART one.
+ */
+void nx_log_set_sinks(U32 sinks);
+
+/** Write out pending records.
+ *
+ * Do not call this from interrupt handlers.
+ */
+void nx_log_flush(void);
+
+/** Return the number of records waiting to be written. */
+U32 nx_log_get_pending(void);
+
+/** Get the log statistics.
+ *
+ * @param stats The structure to fill.
+ */
+void nx_log_get_stats(nx_log_stats_t *stats);
+
+/*@}*/
+/*@}*/
+
+#endif /* __DE1SOC__ */
+#endif /* __NXOS_BASE_LIB_LOG_H__ */
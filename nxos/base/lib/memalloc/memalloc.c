@@ -32,7 +32,7 @@ void nx_memalloc_init(void) {
 }
 
 U32 nx_memalloc_used(void) {
-  return get_used_size(mp);
+  return mp != NULL ? get_used_size(mp) : 0;
 }
 
 void nx_memalloc_destroy(void) {
@@ -67,7 +67,8 @@ void nx_memalloc_init_full(void *mem_pool, U32 mem_pool_size);
 
 /** Return the amount of memory used by the allocator.
  *
- * @return The amount of memory used, in bytes.
+ * @return The amount of memory used, in bytes, or 0 if the allocator
+ * is not initialized.
  *
  * @note The amount return includes both user-usable allocated memory
  * and TLSF overhead.
@@ -0,0 +1,152 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/display.h"
+#include "base/drivers/systick.h"
+#include "base/drivers/uart.h"
+
+#include "base/lib/mirror/mirror.h"
+
+#ifdef __DE1SOC__
+
+/* Longest row the encoder handles, and the worst case size of its
+ * frame: every 128 characters cost one extra control byte.
+ */
+#define MAX_ROW 128
+#define HEADER_SIZE 6
+#define MAX_PAYLOAD (MAX_ROW + (MAX_ROW + 127) / 128)
+#define MAX_FRAME (HEADER_SIZE + MAX_PAYLOAD + 1)
+
+/* Shortest repetition worth a run of its own. */
+#define MIN_RUN 3
+
+static struct {
+  bool active;
+  U32 rate;
+  U32 tokens;
+  U32 fraction; /* Token fraction, in thousandths. */
+  U32 depth;
+  U32 last_ms;
+  U16 seq;
+  U32 bytes_sent;
+} mirror;
+
+/* Run-length encode len characters into out, and return the encoded
+ * size.
+ */
+static U32 encode_row(const U8 *cells, U32 len, U8 *out) {
+  U32 i = 0, n = 0, run, lit;
+
+  while (i < len) {
+    for (run = 1; i + run < len && run < 128 && cells[i + run] == cells[i]; run++);
+
+    if (run >= MIN_RUN) {
+      out[n++] = (U8)(0x80 | (run - 1));
+      out[n++] = cells[i];
+      i += run;
+      continue;
+    }
+
+    /* Literals, up to the next run worth encoding. */
+    for (lit = 0; i + lit < len && lit < 128; lit++) {
+      if (i + lit + MIN_RUN <= len &&
+          cells[i + lit] == cells[i + lit + 1] &&
+          cells[i + lit] == cells[i + lit + 2])
+        break;
+    }
+    out[n++] = (U8)(lit - 1);
+    memcpy(&out[n], &cells[i], lit);
+    n += lit;
+    i += lit;
+  }
+
+  return n;
+}
+
+static U32 send_row(U32 row, const U8 *cells, U32 len) {
+  U8 frame[MAX_FRAME];
+  U32 n, i;
+  U8 check = 0;
+
+  n = encode_row(cells, MIN(len, MAX_ROW), &frame[HEADER_SIZE]);
+
+  frame[0] = NX_MIRROR_SYNC;
+  frame[1] = NX_MIRROR_ROW;
+  frame[2] = (U8)mirror.seq;
+  frame[3] = (U8)(mirror.seq >> 8);
+  frame[4] = (U8)row;
+  frame[5] = (U8)n;
+  for (i = 2; i < HEADER_SIZE + n; i++)
+    check ^= frame[i];
+  frame[HEADER_SIZE + n] = check;
+  n += HEADER_SIZE + 1;
+
+  nx_uart_writebuf(frame, n);
+  mirror.seq++;
+  mirror.bytes_sent += n;
+
+  return n;
+}
+
+/* Refill the token bucket with the budget for the elapsed time. */
+static void refill(void) {
+  U32 now = nx_systick_get_ms();
+  U32 elapsed = MIN(now - mirror.last_ms, 1000);
+  U32 acc;
+
+  mirror.last_ms = now;
+  acc = elapsed * mirror.rate + mirror.fraction;
+  mirror.tokens += acc / 1000;
+  mirror.fraction = acc % 1000;
+  if (mirror.tokens > mirror.depth)
+    mirror.tokens = mirror.depth;
+}
+
+void nx_mirror_init(U32 bytes_per_sec) {
+  mirror.rate = bytes_per_sec;
+  /* Allow bursts of a tenth of a second, and at least one row. */
+  mirror.depth = MAX(bytes_per_sec / 10, MAX_FRAME);
+  mirror.tokens = MAX_FRAME;
+  mirror.fraction = 0;
+  mirror.last_ms = nx_systick_get_ms();
+  mirror.seq = 0;
+  mirror.bytes_sent = 0;
+  mirror.active = TRUE;
+  nx_display_mirror_enable(TRUE);
+}
+
+void nx_mirror_stop(void) {
+  mirror.active = FALSE;
+  nx_display_mirror_enable(FALSE);
+}
+
+void nx_mirror_flush(void) {
+  const U8 *cells;
+  U32 len;
+  S32 row;
+
+  if (!mirror.active)
+    return;
+
+  refill();
+
+  /* Only take a row when its frame fits in the budget whatever its
+   * contents, so that it never has to be queued back.
+   */
+  while (mirror.tokens >= MAX_FRAME &&
+         (row = nx_display_mirror_take(&cells, &len)) >= 0)
+    mirror.tokens -= send_row(row, cells, len);
+}
+
+U32 nx_mirror_get_bytes_sent(void) {
+  return mirror.bytes_sent;
+}
+
+#endif /* __DE1SOC__ */
@@ -0,0 +1,81 @@
+/** @file mirror.h
+ *  @brief Remote display mirror over the UART.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_LIB_MIRROR_H__
+#define __NXOS_BASE_LIB_MIRROR_H__
+
+#include "base/types.h"
+
+#ifdef __DE1SOC__
+
+/** @addtogroup lib */
+/*@{*/
+
+/** @defgroup mirror Remote display mirror
+ *
+ * Sends the text display to a host over the JTAG UART, for headless
+ * test rigs. @c scripts/nxmirror.py rebuilds the screen in a terminal
+ * from the UART output.
+ *
+ * Only the rows refreshed since they were last sent are transmitted,
+ * run-length encoded and straight from the display buffer. The output
+ * rate is capped by a budget in bytes per second: rows that do not fit
+ * in the budget stay queued, and are sent in their latest state later.
+ *
+ * Each row is sent as a frame:
+ *
+ * - @c NX_MIRROR_SYNC, then @c NX_MIRROR_ROW.
+ * - A 16-bit sequence number, little endian, incremented per frame.
+ * - The row number, from the top of the screen.
+ * - The payload length, then the payload.
+ * - The XOR of all the bytes from the sequence number to the end of
+ *   the payload.
+ *
+ * The payload is a series of runs, each starting with a control byte
+ * @a c: if @a c is below 0x80, @a c + 1 literal characters follow;
+ * otherwise the single following character is repeated (@a c & 0x7F)
+ * + 1 times. Characters of value 0 are blanks.
+ *
+ * The display driver never prints control characters, so the frames
+ * can be told from ordinary console output on the same UART.
+ */
+/*@{*/
+
+#define NX_MIRROR_SYNC 0x01 /**< First byte of a frame. */
+#define NX_MIRROR_ROW 'R' /**< Second byte of a row frame. */
+
+/** Start mirroring the display.
+ *
+ * The whole screen is queued for sending.
+ *
+ * @param bytes_per_sec The output budget.
+ */
+void nx_mirror_init(U32 bytes_per_sec);
+
+/** Stop mirroring the display. */
+void nx_mirror_stop(void);
+
+/** Send the queued rows that fit in the budget.
+ *
+ * Call this regularly from the main loop of the application, e.g.
+ * after drawing a screen.
+ */
+void nx_mirror_flush(void);
+
+/** Return the number of bytes sent since nx_mirror_init(). */
+U32 nx_mirror_get_bytes_sent(void);
+
+/*@}*/
+/*@}*/
+
+#endif /* __DE1SOC__ */
+#endif /* __NXOS_BASE_LIB_MIRROR_H__ */
@@ -0,0 +1,194 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include <stdarg.h>
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/assert.h"
+#include "base/format.h"
+#include "base/lib/link/link.h"
+
+#include "base/lib/mux/mux.h"
+
+#ifdef __DE1SOC__
+
+/* Datagram rings hold each write behind its 16 bit length, little
+ * endian. Stream rings hold the bytes alone.
+ */
+#define RECORD_HEADER 2
+
+/* The channels, by increasing priority value. */
+static nx_mux_channel_t *channels;
+
+/* The packet being sent. */
+static U8 packet[NX_LINK_MTU];
+
+static inline U32 ring_free(nx_mux_channel_t *ch) {
+  return ch->size - (ch->head - ch->tail);
+}
+
+static void ring_put(nx_mux_channel_t *ch, const U8 *data, U32 len) {
+  while (len-- > 0)
+    ch->buf[ch->head++ & (ch->size - 1)] = *data++;
+}
+
+static void ring_peek(nx_mux_channel_t *ch, U32 offset, U8 *data, U32 len) {
+  U32 i = ch->tail + offset;
+
+  while (len-- > 0)
+    *data++ = ch->buf[i++ & (ch->size - 1)];
+}
+
+void nx_mux_init(void) {
+  channels = NULL;
+}
+
+void nx_mux_add(nx_mux_channel_t *ch, U8 port, U8 priority, U8 flags,
+                U8 *buf, U32 size) {
+  nx_mux_channel_t **p;
+
+  NX_ASSERT(size > RECORD_HEADER && (size & (size - 1)) == 0);
+
+  memset(ch, 0, sizeof(*ch));
+  ch->port = port;
+  ch->priority = priority;
+  ch->flags = flags;
+  ch->buf = buf;
+  ch->size = size;
+
+  /* After the channels of the same priority. */
+  for (p = &channels; *p != NULL && (*p)->priority <= priority;
+       p = &(*p)->next);
+  ch->next = *p;
+  *p = ch;
+}
+
+/* Queue one datagram of at most NX_LINK_MTU bytes. */
+static bool write_record(nx_mux_channel_t *ch, const U8 *data, U32 len) {
+  U8 header[RECORD_HEADER] = { len, len >> 8 };
+
+  NX_ASSERT(len + RECORD_HEADER <= ch->size);
+
+  while (ring_free(ch) < len + RECORD_HEADER) {
+    if (ch->flags & NX_MUX_DROP)
+      return FALSE;
+    nx_mux_pump();
+  }
+
+  ring_put(ch, header, RECORD_HEADER);
+  ring_put(ch, data, len);
+  return TRUE;
+}
+
+bool nx_mux_write(nx_mux_channel_t *ch, const void *data, U32 len) {
+  const U8 *p = data;
+  U32 n, records;
+
+  if (ch->flags & NX_MUX_DATAGRAM) {
+    /* A dropping channel takes all the records of the write, or none:
+     * the first ones must not go out without the last.
+     */
+    records = MAX((len + NX_LINK_MTU - 1) / NX_LINK_MTU, 1);
+    if ((ch->flags & NX_MUX_DROP) &&
+        ring_free(ch) < len + records * RECORD_HEADER) {
+      ch->dropped++;
+      return FALSE;
+    }
+
+    do {
+      n = MIN(len, NX_LINK_MTU);
+      if (!write_record(ch, p, n)) {
+        ch->dropped++;
+        return FALSE;
+      }
+      p += n;
+      len -= n;
+    } while (len > 0);
+    return TRUE;
+  }
+
+  if ((ch->flags & NX_MUX_DROP) && ring_free(ch) < len) {
+    ch->dropped++;
+    return FALSE;
+  }
+
+  while (len > 0) {
+    n = MIN(len, ring_free(ch));
+    ring_put(ch, p, n);
+    p += n;
+    len -= n;
+    if (len > 0)
+      nx_mux_pump();
+  }
+  return TRUE;
+}
+
+bool nx_mux_printf(nx_mux_channel_t *ch, const char *fmt, ...) {
+  char buf[NX_PRINTF_BUFSIZE];
+  va_list ap;
+  U32 len;
+
+  va_start(ap, fmt);
+  len = nx_vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+
+  return nx_mux_write(ch, buf, MIN(len, sizeof(buf) - 1));
+}
+
+/* Send the next packet of a channel if the link can take it now. */
+static bool send_next(nx_mux_channel_t *ch) {
+  bool reliable = (ch->flags & NX_MUX_RELIABLE) != 0;
+  U8 header[RECORD_HEADER];
+  U32 len, offset;
+
+  if (ch->head == ch->tail)
+    return FALSE;
+
+  if (ch->flags & NX_MUX_DATAGRAM) {
+    ring_peek(ch, 0, header, RECORD_HEADER);
+    len = header[0] | (header[1] << 8);
+    offset = RECORD_HEADER;
+  } else {
+    len = MIN(ch->head - ch->tail, NX_MUX_CHUNK);
+    offset = 0;
+  }
+
+  if (!nx_link_ready(len, reliable))
+    return FALSE;
+
+  ring_peek(ch, offset, packet, len);
+  ch->tail += offset + len;
+  ch->sent += len;
+  nx_link_send(ch->port, packet, len, reliable);
+  return TRUE;
+}
+
+void nx_mux_pump(void) {
+  nx_mux_channel_t *ch;
+  bool sent;
+
+  nx_link_poll();
+
+  /* Strict priority: after each packet, start over from the top. */
+  do {
+    sent = FALSE;
+    for (ch = channels; ch != NULL && !sent; ch = ch->next)
+      sent = send_next(ch);
+  } while (sent);
+}
+
+U32 nx_mux_get_sent(nx_mux_channel_t *ch) {
+  return ch->sent;
+}
+
+U32 nx_mux_get_dropped(nx_mux_channel_t *ch) {
+  return ch->dropped;
+}
+
+#endif /* __DE1SOC__ */
@@ -0,0 +1,142 @@
+/** @file mux.h
+ *  @brief Prioritized logical channels over the packet link.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_LIB_MUX_H__
+#define __NXOS_BASE_LIB_MUX_H__
+
+#include "base/types.h"
+
+#ifdef __DE1SOC__
+
+/** @addtogroup lib */
+/*@{*/
+
+/** @defgroup mux Channel multiplexer
+ *
+ * Several streams (console text, telemetry, traces, control messages)
+ * sharing one link, each on its own port of the packet link (see
+ * link.h), so that they do not interleave on the wire.
+ *
+ * Each channel queues its writes in a ring provided by the caller.
+ * nx_mux_pump() then sends them in order of channel priority: a
+ * channel only gets the link when the channels above it have nothing
+ * ready to send. Packets are only handed to the link when it can take
+ * them without waiting, so a busy low priority channel holds up a
+ * higher one by one packet at most.
+ *
+ * When its ring is full, a channel either waits, pumping the link
+ * (@c NX_MUX_BLOCK), or drops the write and counts it
+ * (@c NX_MUX_DROP). Telemetry and trace channels should drop: they
+ * then never block the console.
+ *
+ * Writes are kept whole on datagram channels: each one goes in a
+ * packet of its own, so that losing a packet loses whole records. On
+ * the other channels, consecutive writes are coalesced into packets
+ * of up to @c NX_MUX_CHUNK bytes.
+ *
+ * @note These routines must not be called from interrupt handlers.
+ */
+/*@{*/
+
+#define NX_MUX_CHUNK 128 /**< Maximum payload of a coalesced packet. */
+
+/** @name Conventional ports */
+/*@{*/
+#define NX_MUX_PORT_CONSOLE 0 /**< Console text. */
+#define NX_MUX_PORT_CONTROL 2 /**< Control requests and replies. */
+#define NX_MUX_PORT_TELEMETRY 3 /**< Periodic measurements. */
+#define NX_MUX_PORT_TRACE 4 /**< Trace records. */
+/*@}*/
+
+/** @name Channel flags */
+/*@{*/
+#define NX_MUX_RELIABLE 0x01 /**< Send in reliable packets. */
+#define NX_MUX_DROP 0x02 /**< Drop writes when full, instead of waiting. */
+#define NX_MUX_DATAGRAM 0x04 /**< Send each write in a packet of its own. */
+/*@}*/
+
+/** @brief A logical channel. Its fields are private. */
+typedef struct nx_mux_channel {
+  struct nx_mux_channel *next;
+  U8 port;
+  U8 priority;
+  U8 flags;
+  U8 *buf;
+  U32 size;
+  U32 head, tail;
+  U32 sent;
+  U32 dropped;
+} nx_mux_channel_t;
+
+/** Initialize the multiplexer, with no channels.
+ *
+ * The link must be initialized first (see nx_link_init()).
+ */
+void nx_mux_init(void);
+
+/** Set up a channel and add it to the multiplexer.
+ *
+ * @param ch The channel.
+ * @param port The link port of the channel.
+ * @param priority The priority of the channel, 0 being the highest.
+ * @param flags A combination of the channel flags.
+ * @param buf The ring of the channel.
+ * @param size The size of @a buf, a power of 2.
+ */
+void nx_mux_add(nx_mux_channel_t *ch, U8 port, U8 priority, U8 flags,
+                U8 *buf, U32 size);
+
+/** Queue @a len bytes of @a data on a channel.
+ *
+ * Writes larger than @c NX_LINK_MTU are split: on a datagram channel,
+ * into records of up to @c NX_LINK_MTU bytes, each sent in a packet
+ * of its own. With @c NX_MUX_DROP, the write is queued whole or not
+ * at all; otherwise this waits for room, pumping the link.
+ *
+ * Each record of a datagram channel takes its size plus 2 bytes in
+ * the ring: a record larger than the ring fails an assertion.
+ *
+ * @param ch The channel.
+ * @param data The bytes to send.
+ * @param len The number of bytes.
+ * @return FALSE if the write was dropped.
+ */
+bool nx_mux_write(nx_mux_channel_t *ch, const void *data, U32 len);
+
+/** Write formatted output on a channel.
+ *
+ * See nx_snprintf() for the format. The output is truncated to
+ * NX_PRINTF_BUFSIZE - 1 characters.
+ *
+ * @param ch The channel.
+ * @param fmt The format string.
+ * @return FALSE if the write was dropped.
+ */
+bool nx_mux_printf(nx_mux_channel_t *ch, const char *fmt, ...)
+  __attribute__((format(printf, 2, 3)));
+
+/** Poll the link and send what the channels queued, as far as the
+ * link can take it without waiting. Call this regularly.
+ */
+void nx_mux_pump(void);
+
+/** Return the number of bytes sent on a channel. */
+U32 nx_mux_get_sent(nx_mux_channel_t *ch);
+
+/** Return the number of writes dropped on a channel. */
+U32 nx_mux_get_dropped(nx_mux_channel_t *ch);
+
+/*@}*/
+/*@}*/
+
+#endif /* __DE1SOC__ */
+#endif /* __NXOS_BASE_LIB_MUX_H__ */
@@ -0,0 +1,342 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+
+#include "base/lib/neon/neon.h"
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+const bool nx_neon_enabled = TRUE;
+#else
+const bool nx_neon_enabled = FALSE;
+#endif
+
+/* CRC-32 lookup tables, built on first use. Table 0 is the classic
+ * byte-at-a-time table, tables 1 to 3 extend it to 4 bytes per step
+ * ("slicing by 4").
+ */
+#define CRC32_POLY 0xEDB88320
+
+static U32 crc_table[4][256];
+static bool crc_table_ready = FALSE;
+
+static void crc_table_init(void) {
+  U32 i, j, c;
+
+  for (i = 0; i < 256; i++) {
+    c = i;
+    for (j = 0; j < 8; j++)
+      c = (c & 1) ? (c >> 1) ^ CRC32_POLY : c >> 1;
+    crc_table[0][i] = c;
+  }
+
+  for (i = 0; i < 256; i++) {
+    for (j = 1; j < 4; j++) {
+      c = crc_table[j - 1][i];
+      crc_table[j][i] = (c >> 8) ^ crc_table[0][c & 0xFF];
+    }
+  }
+
+  crc_table_ready = TRUE;
+}
+
+/* Add n bytes, as little endian 16-bit words, to a 32-bit ones'
+ * complement accumulator.
+ */
+static U32 sum16(const U8 *buf, U32 n, U32 sum) {
+  while (n >= 2) {
+    sum += buf[0] | (buf[1] << 8);
+    if (sum & 0x80000000)
+      sum = (sum & 0xFFFF) + (sum >> 16);
+    buf += 2;
+    n -= 2;
+  }
+
+  if (n)
+    sum += buf[0];
+
+  return sum;
+}
+
+static U16 fold16(U32 sum) {
+  while (sum >> 16)
+    sum = (sum & 0xFFFF) + (sum >> 16);
+
+  return (U16)sum;
+}
+
+static inline S16 saturate16(S32 v) {
+  if (v > 32767)
+    return 32767;
+  if (v < -32768)
+    return -32768;
+  return (S16)v;
+}
+
+/*
+ * Scalar versions.
+ */
+
+void nx_neon_fill32_scalar(U32 *dst, U32 val, U32 count) {
+  while (count--)
+    *dst++ = val;
+}
+
+void nx_neon_copy_scalar(void *dst, const void *src, U32 n) {
+  memcpy(dst, src, n);
+}
+
+void nx_neon_fill16_scalar(U16 *dst, U16 color, U32 count) {
+  while (count--)
+    *dst++ = color;
+}
+
+void nx_neon_blend565_scalar(U16 *dst, const U16 *src, U32 alpha, U32 count) {
+  U32 w = alpha + (alpha >> 7), iw = 256 - w;
+  U32 s, d, r, g, b;
+
+  while (count--) {
+    s = *src++;
+    d = *dst;
+    r = ((s >> 11) * w + (d >> 11) * iw) >> 8;
+    g = (((s >> 5) & 0x3F) * w + ((d >> 5) & 0x3F) * iw) >> 8;
+    b = ((s & 0x1F) * w + (d & 0x1F) * iw) >> 8;
+    *dst++ = (U16)((r << 11) | (g << 5) | b);
+  }
+}
+
+void nx_neon_mix_s16_scalar(S16 *dst, const S16 *src, U32 count) {
+  while (count--) {
+    *dst = saturate16((S32)*dst + *src++);
+    dst++;
+  }
+}
+
+void nx_neon_gain_stereo_s16_scalar(S16 *buf, U32 frames,
+                                    S16 gain_l, S16 gain_r) {
+  while (frames--) {
+    buf[0] = saturate16(((S32)buf[0] * gain_l) >> 8);
+    buf[1] = saturate16(((S32)buf[1] * gain_r) >> 8);
+    buf += 2;
+  }
+}
+
+U16 nx_neon_checksum16_scalar(const U8 *buf, U32 n) {
+  return fold16(sum16(buf, n, 0));
+}
+
+U32 nx_neon_crc32_scalar(U32 crc, const U8 *buf, U32 n) {
+  if (!crc_table_ready)
+    crc_table_init();
+
+  crc = ~crc;
+  while (n--)
+    crc = (crc >> 8) ^ crc_table[0][(crc ^ *buf++) & 0xFF];
+
+  return ~crc;
+}
+
+/*
+ * Accelerated versions.
+ */
+
+#ifdef __ARM_NEON__
+
+void nx_neon_fill32(U32 *dst, U32 val, U32 count) {
+  uint32x4_t v = vdupq_n_u32((uint32_t)val);
+
+  for (; count >= 8; count -= 8, dst += 8) {
+    vst1q_u32((uint32_t*)dst, v);
+    vst1q_u32((uint32_t*)dst + 4, v);
+  }
+
+  nx_neon_fill32_scalar(dst, val, count);
+}
+
+void nx_neon_copy(void *dst, const void *src, U32 n) {
+  uint8_t *d = (uint8_t*)dst;
+  const uint8_t *s = (const uint8_t*)src;
+  uint8x16_t a, b, c, e;
+
+  /* Small copies are not worth the NEON setup. */
+  if (n < 64) {
+    memcpy(dst, src, n);
+    return;
+  }
+
+  for (; n >= 64; n -= 64, d += 64, s += 64) {
+    a = vld1q_u8(s);
+    b = vld1q_u8(s + 16);
+    c = vld1q_u8(s + 32);
+    e = vld1q_u8(s + 48);
+    vst1q_u8(d, a);
+    vst1q_u8(d + 16, b);
+    vst1q_u8(d + 32, c);
+    vst1q_u8(d + 48, e);
+  }
+
+  memcpy(d, s, n);
+}
+
+void nx_neon_fill16(U16 *dst, U16 color, U32 count) {
+  uint16x8_t v = vdupq_n_u16(color);
+
+  for (; count >= 16; count -= 16, dst += 16) {
+    vst1q_u16(dst, v);
+    vst1q_u16(dst + 8, v);
+  }
+
+  nx_neon_fill16_scalar(dst, color, count);
+}
+
+void nx_neon_blend565(U16 *dst, const U16 *src, U32 alpha, U32 count) {
+  U32 w = alpha + (alpha >> 7);
+  uint16x8_t vw = vdupq_n_u16((uint16_t)w);
+  uint16x8_t viw = vdupq_n_u16((uint16_t)(256 - w));
+  uint16x8_t mask6 = vdupq_n_u16(0x3F), mask5 = vdupq_n_u16(0x1F);
+  uint16x8_t s, d, r, g, b;
+
+  /* The channels are blended in 16-bit lanes: the largest product,
+   * 63 * 256, still fits.
+   */
+  for (; count >= 8; count -= 8, dst += 8, src += 8) {
+    s = vld1q_u16(src);
+    d = vld1q_u16(dst);
+
+    r = vmulq_u16(vshrq_n_u16(s, 11), vw);
+    r = vmlaq_u16(r, vshrq_n_u16(d, 11), viw);
+    r = vshrq_n_u16(r, 8);
+
+    g = vmulq_u16(vandq_u16(vshrq_n_u16(s, 5), mask6), vw);
+    g = vmlaq_u16(g, vandq_u16(vshrq_n_u16(d, 5), mask6), viw);
+    g = vshrq_n_u16(g, 8);
+
+    b = vmulq_u16(vandq_u16(s, mask5), vw);
+    b = vmlaq_u16(b, vandq_u16(d, mask5), viw);
+    b = vshrq_n_u16(b, 8);
+
+    vst1q_u16(dst, vorrq_u16(vshlq_n_u16(r, 11),
+                             vorrq_u16(vshlq_n_u16(g, 5), b)));
+  }
+
+  nx_neon_blend565_scalar(dst, src, alpha, count);
+}
+
+void nx_neon_mix_s16(S16 *dst, const S16 *src, U32 count) {
+  for (; count >= 8; count -= 8, dst += 8, src += 8)
+    vst1q_s16(dst, vqaddq_s16(vld1q_s16(dst), vld1q_s16(src)));
+
+  nx_neon_mix_s16_scalar(dst, src, count);
+}
+
+void nx_neon_gain_stereo_s16(S16 *buf, U32 frames, S16 gain_l, S16 gain_r) {
+  const S16 gains[4] = { gain_l, gain_r, gain_l, gain_r };
+  int16x4_t g = vld1_s16(gains);
+  int16x8_t x;
+  int32x4_t lo, hi;
+
+  /* 4 frames per step: widen, multiply, then shift back down to 16 bits
+   * with saturation.
+   */
+  for (; frames >= 4; frames -= 4, buf += 8) {
+    x = vld1q_s16(buf);
+    lo = vmull_s16(vget_low_s16(x), g);
+    hi = vmull_s16(vget_high_s16(x), g);
+    vst1q_s16(buf, vcombine_s16(vqshrn_n_s32(lo, 8), vqshrn_n_s32(hi, 8)));
+  }
+
+  nx_neon_gain_stereo_s16_scalar(buf, frames, gain_l, gain_r);
+}
+
+U16 nx_neon_checksum16(const U8 *buf, U32 n) {
+  uint32x4_t acc;
+  U32 sum = 0, blocks, lane[4];
+
+  while (n >= 16) {
+    /* Each step adds at most 2 * 0xFFFF to a lane, so the lanes are
+     * reduced every 4096 steps, well before they can overflow.
+     */
+    blocks = MIN(n / 16, 4096);
+    n -= blocks * 16;
+
+    acc = vdupq_n_u32(0);
+    while (blocks--) {
+      acc = vpadalq_u16(acc, vreinterpretq_u16_u8(vld1q_u8(buf)));
+      buf += 16;
+    }
+
+    vst1q_u32((uint32_t*)lane, acc);
+    sum = fold16(sum) + fold16(lane[0]) + fold16(lane[1]) +
+      fold16(lane[2]) + fold16(lane[3]);
+  }
+
+  return fold16(sum16(buf, n, sum));
+}
+
+U32 nx_neon_crc32(U32 crc, const U8 *buf, U32 n) {
+  /* Without a polynomial multiply instruction on the Cortex-A9, the
+   * fastest option is a wider table lookup: 4 bytes per step.
+   */
+  if (!crc_table_ready)
+    crc_table_init();
+
+  crc = ~crc;
+  while (n && ((U32)buf & 3)) {
+    crc = (crc >> 8) ^ crc_table[0][(crc ^ *buf++) & 0xFF];
+    n--;
+  }
+
+  for (; n >= 4; n -= 4, buf += 4) {
+    crc ^= *(const U32*)buf;
+    crc = crc_table[3][crc & 0xFF] ^ crc_table[2][(crc >> 8) & 0xFF] ^
+      crc_table[1][(crc >> 16) & 0xFF] ^ crc_table[0][crc >> 24];
+  }
+
+  while (n--)
+    crc = (crc >> 8) ^ crc_table[0][(crc ^ *buf++) & 0xFF];
+
+  return ~crc;
+}
+
+#else /* !__ARM_NEON__ */
+
+void nx_neon_fill32(U32 *dst, U32 val, U32 count) {
+  nx_neon_fill32_scalar(dst, val, count);
+}
+
+void nx_neon_copy(void *dst, const void *src, U32 n) {
+  nx_neon_copy_scalar(dst, src, n);
+}
+
+void nx_neon_fill16(U16 *dst, U16 color, U32 count) {
+  nx_neon_fill16_scalar(dst, color, count);
+}
+
+void nx_neon_blend565(U16 *dst, const U16 *src, U32 alpha, U32 count) {
+  nx_neon_blend565_scalar(dst, src, alpha, count);
+}
+
+void nx_neon_mix_s16(S16 *dst, const S16 *src, U32 count) {
+  nx_neon_mix_s16_scalar(dst, src, count);
+}
+
+void nx_neon_gain_stereo_s16(S16 *buf, U32 frames, S16 gain_l, S16 gain_r) {
+  nx_neon_gain_stereo_s16_scalar(buf, frames, gain_l, gain_r);
+}
+
+U16 nx_neon_checksum16(const U8 *buf, U32 n) {
+  return nx_neon_checksum16_scalar(buf, n);
+}
+
+U32 nx_neon_crc32(U32 crc, const U8 *buf, U32 n) {
+  return nx_neon_crc32_scalar(crc, buf, n);
+}
+
+#endif /* __ARM_NEON__ */
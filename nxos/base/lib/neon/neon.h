@@ -0,0 +1,124 @@
+/** @file neon.h
+ *  @brief Vectorized block, pixel, audio and checksum kernels.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_LIB_NEON_H__
+#define __NXOS_BASE_LIB_NEON_H__
+
+#include "base/types.h"
+
+/** @addtogroup lib */
+/*@{*/
+
+/** @defgroup neon NEON kernels
+ *
+ * Inner loops for the graphics, audio and communication code, written
+ * with NEON intrinsics when the kernel is built for the Cortex-A9 with
+ * NEON enabled (@c NEON=1 on the make command line).
+ *
+ * Every kernel also has a plain C version, with the @c _scalar suffix,
+ * which is always available and gives bit-exact results. On other
+ * builds, the accelerated entry points simply call the scalar ones, so
+ * that applications do not need to care about the target.
+ *
+ * No buffer alignment is required, but 8 byte aligned buffers are
+ * faster.
+ */
+/*@{*/
+
+/** TRUE when the accelerated kernels are really using NEON. */
+extern const bool nx_neon_enabled;
+
+/** @name Block operations */
+/*@{*/
+
+/** Fill @a count 32-bit words at @a dst with @a val. */
+void nx_neon_fill32(U32 *dst, U32 val, U32 count);
+void nx_neon_fill32_scalar(U32 *dst, U32 val, U32 count);
+
+/** Copy @a n bytes from @a src to @a dst. The buffers must not overlap. */
+void nx_neon_copy(void *dst, const void *src, U32 n);
+void nx_neon_copy_scalar(void *dst, const void *src, U32 n);
+/*@}*/
+
+/** @name RGB565 pixel operations */
+/*@{*/
+
+/** Fill @a count 16-bit pixels at @a dst with @a color. */
+void nx_neon_fill16(U16 *dst, U16 color, U32 count);
+void nx_neon_fill16_scalar(U16 *dst, U16 color, U32 count);
+
+/** Alpha blend @a count RGB565 pixels of @a src over @a dst.
+ *
+ * @param dst The destination pixels, also the blend result.
+ * @param src The source pixels.
+ * @param alpha The source opacity, from 0 (transparent) to 255
+ * (opaque).
+ * @param count The number of pixels.
+ */
+void nx_neon_blend565(U16 *dst, const U16 *src, U32 alpha, U32 count);
+void nx_neon_blend565_scalar(U16 *dst, const U16 *src, U32 alpha, U32 count);
+/*@}*/
+
+/** @name Audio sample operations
+ *
+ * Samples are signed 16-bit, and results saturate instead of wrapping
+ * around.
+ */
+/*@{*/
+
+/** Mix @a count samples of @a src into @a dst. */
+void nx_neon_mix_s16(S16 *dst, const S16 *src, U32 count);
+void nx_neon_mix_s16_scalar(S16 *dst, const S16 *src, U32 count);
+
+/** Apply a gain to interleaved stereo samples, in place.
+ *
+ * @param buf The samples, left channel first.
+ * @param frames The number of stereo frames (pairs of samples).
+ * @param gain_l The left channel gain, in Q8.8 fixed point (256 is
+ * unity gain).
+ * @param gain_r The right channel gain, in Q8.8 fixed point.
+ */
+void nx_neon_gain_stereo_s16(S16 *buf, U32 frames, S16 gain_l, S16 gain_r);
+void nx_neon_gain_stereo_s16_scalar(S16 *buf, U32 frames,
+                                    S16 gain_l, S16 gain_r);
+/*@}*/
+
+/** @name Checksums */
+/*@{*/
+
+/** Compute the ones' complement sum (RFC 1071) of @a n bytes.
+ *
+ * The data is summed as little endian 16-bit words, an odd trailing
+ * byte being padded with zero. The result is the folded sum, not its
+ * complement.
+ */
+U16 nx_neon_checksum16(const U8 *buf, U32 n);
+U16 nx_neon_checksum16_scalar(const U8 *buf, U32 n);
+
+/** Update a CRC-32 (IEEE 802.3, as used by zlib) with @a n bytes.
+ *
+ * @param crc The CRC of the previous data, 0 to start a new CRC.
+ * @param buf The data.
+ * @param n The number of bytes.
+ * @return The updated CRC.
+ *
+ * @note The Cortex-A9 has no polynomial multiply instruction, so this
+ * is a table-driven kernel in both versions.
+ */
+U32 nx_neon_crc32(U32 crc, const U8 *buf, U32 n);
+U32 nx_neon_crc32_scalar(U32 crc, const U8 *buf, U32 n);
+/*@}*/
+
+/*@}*/
+/*@}*/
+
+#endif /* __NXOS_BASE_LIB_NEON_H__ */
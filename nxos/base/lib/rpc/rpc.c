@@ -0,0 +1,210 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/drivers/systick.h"
+#include "base/lib/link/link.h"
+
+#include "base/lib/rpc/rpc.h"
+
+#ifdef __DE1SOC__
+
+#define REQ_HEADER 8
+#define REPLY_HEADER 4
+#define CALL_REPLY (REPLY_HEADER + 20)
+#define LIST_REPLY (REPLY_HEADER + 3)
+#define MAX_NAME (NX_LINK_MTU - LIST_REPLY)
+
+static struct {
+  /* Sorted by id. */
+  const nx_rpc_func_t *funcs[NX_RPC_MAX_FUNCS];
+  U32 count;
+
+  U32 calls;
+
+  U8 request[NX_LINK_MTU];
+  U8 reply[NX_LINK_MTU];
+} rpc;
+
+static U32 nop(const U32 *args __attribute__((unused))) {
+  return 0;
+}
+
+static const nx_rpc_func_t builtin_nop = { NX_RPC_ID_NOP, 0, "nop", nop };
+
+static U16 get_u16(const U8 *p) {
+  return p[0] | (p[1] << 8);
+}
+
+static U32 get_u32(const U8 *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((U32)p[3] << 24);
+}
+
+static void put_u16(U8 *p, U16 v) {
+  p[0] = v;
+  p[1] = v >> 8;
+}
+
+static void put_u32(U8 *p, U32 v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+/* Binary search: return the index of id, or where to insert it. */
+static U32 lookup(U16 id, bool *found) {
+  U32 lo = 0, hi = rpc.count, mid;
+
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (rpc.funcs[mid]->id == id) {
+      *found = TRUE;
+      return mid;
+    }
+    if (id < rpc.funcs[mid]->id)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  *found = FALSE;
+  return lo;
+}
+
+bool nx_rpc_register(const nx_rpc_func_t *func) {
+  bool found;
+  U32 i;
+
+  if (rpc.count == NX_RPC_MAX_FUNCS || func->nargs > NX_RPC_MAX_ARGS)
+    return FALSE;
+  i = lookup(func->id, &found);
+  if (found)
+    return FALSE;
+
+  memmove(&rpc.funcs[i + 1], &rpc.funcs[i],
+          (rpc.count - i) * sizeof(rpc.funcs[0]));
+  rpc.funcs[i] = func;
+  rpc.count++;
+  return TRUE;
+}
+
+/* Run a function, and fill in the timings of the reply. The total is
+ * kept in two words, as it can exceed 32 bits over many runs.
+ */
+static U8 call(U16 id, U32 runs, U32 argc, const U8 *argv, U8 *out) {
+  const nx_rpc_func_t *func;
+  U32 args[NX_RPC_MAX_ARGS];
+  U32 i, ret = 0, start, cycles;
+  U32 min = 0xFFFFFFFF, max = 0, total_lo = 0, total_hi = 0;
+  bool found;
+
+  i = lookup(id, &found);
+  if (!found)
+    return NX_RPC_NOT_FOUND;
+  func = rpc.funcs[i];
+  if (argc != func->nargs)
+    return NX_RPC_BAD_ARGS;
+
+  for (i = 0; i < argc; i++)
+    args[i] = get_u32(&argv[i * 4]);
+
+  for (i = 0; i < runs; i++) {
+    start = nx_systick_get_cycles();
+    ret = func->fn(args);
+    cycles = nx_systick_get_cycles() - start;
+
+    min = MIN(min, cycles);
+    max = MAX(max, cycles);
+    total_lo += cycles;
+    if (total_lo < cycles)
+      total_hi++;
+  }
+
+  put_u32(&out[0], ret);
+  put_u32(&out[4], min);
+  put_u32(&out[8], max);
+  put_u32(&out[12], total_lo);
+  put_u32(&out[16], total_hi);
+  rpc.calls++;
+  return NX_RPC_OK;
+}
+
+static U32 list(U16 index, U8 *out, U8 *status) {
+  const nx_rpc_func_t *func;
+  U32 len;
+
+  if (index >= rpc.count) {
+    *status = NX_RPC_NOT_FOUND;
+    return 0;
+  }
+
+  func = rpc.funcs[index];
+  len = MIN(strlen(func->name), MAX_NAME);
+  put_u16(&out[0], func->id);
+  out[2] = func->nargs;
+  memcpy(&out[3], func->name, len);
+  *status = NX_RPC_OK;
+  return 3 + len;
+}
+
+bool nx_rpc_handle(U8 port, const void *data, U32 len) {
+  const U8 *req = data;
+  U32 argc, runs, reply_len = REPLY_HEADER;
+  U8 status = NX_RPC_BAD_REQUEST;
+
+  if (port != NX_RPC_PORT)
+    return FALSE;
+  if (len < REQ_HEADER)
+    return TRUE;
+
+  argc = req[1];
+  runs = MAX(get_u16(&req[6]), 1);
+
+  switch (req[0]) {
+    case NX_RPC_CALL:
+      if (argc > NX_RPC_MAX_ARGS || len != REQ_HEADER + argc * 4)
+        break;
+      status = call(get_u16(&req[4]), runs, argc, &req[REQ_HEADER],
+                    &rpc.reply[REPLY_HEADER]);
+      if (status == NX_RPC_OK)
+        reply_len = CALL_REPLY;
+      break;
+    case NX_RPC_LIST:
+      reply_len += list(get_u16(&req[4]), &rpc.reply[REPLY_HEADER], &status);
+      break;
+  }
+
+  rpc.reply[0] = req[0] | 0x80;
+  rpc.reply[1] = status;
+  rpc.reply[2] = req[2];
+  rpc.reply[3] = req[3];
+  nx_link_send(NX_RPC_PORT, rpc.reply, reply_len, TRUE);
+  return TRUE;
+}
+
+void nx_rpc_poll(void) {
+  S32 len;
+  U8 port;
+
+  nx_link_poll();
+  while ((len = nx_link_recv(&port, rpc.request, sizeof(rpc.request))) >= 0)
+    nx_rpc_handle(port, rpc.request, len);
+}
+
+U32 nx_rpc_get_calls(void) {
+  return rpc.calls;
+}
+
+void nx_rpc_init(void) {
+  rpc.count = 0;
+  rpc.calls = 0;
+  nx_rpc_register(&builtin_nop);
+}
+
+#endif /* __DE1SOC__ */
@@ -0,0 +1,135 @@
+/** @file rpc.h
+ *  @brief Remote procedure calls from the host over the packet link.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_LIB_RPC_H__
+#define __NXOS_BASE_LIB_RPC_H__
+
+#include "base/types.h"
+
+#ifdef __DE1SOC__
+
+/** @addtogroup lib */
+/*@{*/
+
+/** @defgroup rpc Remote procedure calls
+ *
+ * Target functions that a host script calls by number, with a few
+ * 32 bit arguments, getting back their return value and how long they
+ * ran. One image can then run a whole series of measurements, the
+ * host choosing the parameters. @c scripts/nxrpc.py is the host side.
+ *
+ * Requests and replies are reliable packets on port @c NX_RPC_PORT of
+ * the packet link (see link.h). Numbers are little endian. A request
+ * is:
+ *
+ * - The operation: @c NX_RPC_CALL or @c NX_RPC_LIST.
+ * - The number of arguments.
+ * - A tag, 2 bytes, copied to the reply.
+ * - The function id, 2 bytes. For @c NX_RPC_LIST, the index of the
+ *   function in the table instead.
+ * - The number of runs, 2 bytes, 0 counting as 1.
+ * - The arguments, 4 bytes each.
+ *
+ * A reply starts with the operation with bit 7 set, a status byte and
+ * the tag. The reply to a call then carries the return value of the
+ * last run, and the minimum, maximum and total run time in system
+ * timer cycles (see nx_systick_get_cycles()), the total in 8 bytes.
+ * The reply to a list carries the id and number of arguments of the
+ * function, and its name.
+ *
+ * Function @c NX_RPC_ID_NOP is always there, and does nothing: calls
+ * to it measure the timing overhead and the round trip time.
+ *
+ * The functions are registered in a fixed size table, and the packets
+ * built in static buffers: nothing is allocated.
+ *
+ * @note The functions run from nx_rpc_poll() or nx_rpc_handle(), not
+ * from interrupt handlers.
+ */
+/*@{*/
+
+#define NX_RPC_PORT 2 /**< Link port, the control port of mux.h. */
+#define NX_RPC_MAX_ARGS 8 /**< Maximum arguments of a function. */
+#define NX_RPC_MAX_FUNCS 32 /**< Maximum functions, the built-in included. */
+
+#define NX_RPC_ID_NOP 0 /**< Id of the built-in empty function. */
+
+/** @name Operations */
+/*@{*/
+#define NX_RPC_CALL 'C' /**< Run a function. */
+#define NX_RPC_LIST 'L' /**< Describe the function at an index. */
+/*@}*/
+
+/** @name Reply status */
+/*@{*/
+#define NX_RPC_OK 0 /**< Success. */
+#define NX_RPC_BAD_REQUEST 1 /**< Malformed request. */
+#define NX_RPC_NOT_FOUND 2 /**< No such function id or index. */
+#define NX_RPC_BAD_ARGS 3 /**< Wrong number of arguments. */
+/*@}*/
+
+/** A remotely callable function.
+ *
+ * @param args The arguments, as many as declared at registration.
+ * @return A value for the host.
+ */
+typedef U32 (*nx_rpc_fn_t)(const U32 *args);
+
+/** @brief Description of a remotely callable function. */
+typedef struct {
+  U16 id;          /**< The number the host calls it by. */
+  U8 nargs;        /**< The number of arguments, at most @c NX_RPC_MAX_ARGS. */
+  const char *name; /**< The name, for the host. */
+  nx_rpc_fn_t fn;  /**< The function. */
+} nx_rpc_func_t;
+
+/** Initialize the RPC layer, with only the built-in function.
+ *
+ * The link must be initialized first (see nx_link_init()).
+ */
+void nx_rpc_init(void);
+
+/** Add a function.
+ *
+ * @param func The function. It is not copied, and must stay valid.
+ * @return FALSE if the table is full, the id taken or @a nargs too
+ * large.
+ */
+bool nx_rpc_register(const nx_rpc_func_t *func);
+
+/** Serve a received packet, if it is an RPC request.
+ *
+ * For applications that receive packets on other ports too.
+ *
+ * @param port The port of the packet.
+ * @param data The payload.
+ * @param len The payload size.
+ * @return FALSE if the packet is not for the RPC port.
+ */
+bool nx_rpc_handle(U8 port, const void *data, U32 len);
+
+/** Poll the link, and serve the requests received.
+ *
+ * Packets on other ports are discarded: applications using other
+ * ports should call nx_rpc_handle() from their own receive loop
+ * instead.
+ */
+void nx_rpc_poll(void);
+
+/** Return the number of calls served since initialization. */
+U32 nx_rpc_get_calls(void);
+
+/*@}*/
+/*@}*/
+
+#endif /* __DE1SOC__ */
+#endif /* __NXOS_BASE_LIB_RPC_H__ */
@@ -0,0 +1,650 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include <stdarg.h>
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/format.h"
+#include "base/memmap.h"
+#include "base/stack.h"
+#include "base/drivers/aic.h"
+#include "base/drivers/systick.h"
+#include "base/drivers/uart.h"
+#include "base/lib/memalloc/memalloc.h"
+
+#include "base/lib/shell/shell.h"
+
+#ifdef __DE1SOC__
+
+/* Weak, so that the shell does not pull the allocator into images
+ * that do not use it.
+ */
+U32 nx_memalloc_used(void) __attribute__((weak));
+
+#define PROMPT "nxos> "
+#define BENCH_RUNS 10
+#define DUMP_LENGTH 64
+#define PEEK_COUNT 1
+
+#define CTRL(c) ((c) & 0x1F)
+#define ESC 0x1B
+#define DEL 0x7F
+
+typedef enum {
+  INPUT_NORMAL = 0,
+  INPUT_ESC,  /* After ESC. */
+  INPUT_CSI,  /* After ESC [, maybe with a parameter. */
+} input_state_t;
+
+typedef struct {
+  const char *name;
+  nx_closure_t fn;
+} bench_t;
+
+static struct {
+  nx_uart_port_t port;
+
+  /* The line being edited, and the cursor position in it. */
+  char line[NX_SHELL_LINE];
+  U32 len, cursor;
+
+  input_state_t input;
+  U32 csi_param;
+
+  /* The last byte was a CR: skip the LF of a CRLF. */
+  bool after_cr;
+
+  /* Past lines, the most recent at (history_head - 1). browse is how
+   * far back the up arrow went, 0 being the line being edited.
+   */
+  char history[NX_SHELL_HISTORY][NX_SHELL_LINE];
+  U32 history_head, history_count, browse;
+
+  /* Sorted by name. */
+  const nx_shell_cmd_t *commands[NX_SHELL_MAX_COMMANDS];
+  U32 command_count;
+
+  bench_t benches[NX_SHELL_MAX_BENCHES];
+  U32 bench_count;
+} shell;
+
+/*
+ * Output.
+ */
+
+static void out(const char *s, U32 len) {
+  nx_uart_port_writebuf(shell.port, (const U8 *)s, len);
+}
+
+static void out_str(const char *s) {
+  out(s, strlen(s));
+}
+
+void nx_shell_printf(const char *fmt, ...) {
+  char buf[NX_PRINTF_BUFSIZE];
+  va_list ap;
+  U32 len;
+
+  va_start(ap, fmt);
+  len = nx_vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+
+  out(buf, MIN(len, sizeof(buf) - 1));
+}
+
+/* Move the terminal cursor n columns left. */
+static void cursor_left(U32 n) {
+  if (n > 0)
+    nx_shell_printf("\x1b[%luD", n);
+}
+
+/* Redraw the line after the cursor, erasing what follows it. */
+static void redraw_tail(void) {
+  out(&shell.line[shell.cursor], shell.len - shell.cursor);
+  out_str("\x1b[K");
+  cursor_left(shell.len - shell.cursor);
+}
+
+static void redraw_line(void) {
+  out_str("\r" PROMPT);
+  out(shell.line, shell.len);
+  out_str("\x1b[K");
+  cursor_left(shell.len - shell.cursor);
+}
+
+/*
+ * Command table.
+ */
+
+static S32 compare(const char *a, const char *b) {
+  while (*a && *a == *b) {
+    a++;
+    b++;
+  }
+  return (U8)*a - (U8)*b;
+}
+
+/* Binary search: return the index of name, or where to insert it. */
+static U32 lookup(const char *name, bool *found) {
+  U32 lo = 0, hi = shell.command_count, mid;
+  S32 c;
+
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    c = compare(name, shell.commands[mid]->name);
+    if (c == 0) {
+      *found = TRUE;
+      return mid;
+    }
+    if (c < 0)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  *found = FALSE;
+  return lo;
+}
+
+bool nx_shell_register(const nx_shell_cmd_t *cmd) {
+  bool found;
+  U32 i;
+
+  if (shell.command_count == NX_SHELL_MAX_COMMANDS)
+    return FALSE;
+  i = lookup(cmd->name, &found);
+  if (found)
+    return FALSE;
+
+  memmove(&shell.commands[i + 1], &shell.commands[i],
+          (shell.command_count - i) * sizeof(shell.commands[0]));
+  shell.commands[i] = cmd;
+  shell.command_count++;
+  return TRUE;
+}
+
+bool nx_shell_register_bench(const char *name, nx_closure_t fn) {
+  if (shell.bench_count == NX_SHELL_MAX_BENCHES)
+    return FALSE;
+  shell.benches[shell.bench_count].name = name;
+  shell.benches[shell.bench_count].fn = fn;
+  shell.bench_count++;
+  return TRUE;
+}
+
+/*
+ * Built-in commands.
+ */
+
+/* Parse a decimal number, or a hexadecimal one with a 0x prefix. */
+static bool parse_number(const char *s, U32 *value) {
+  U32 v = 0, digit;
+
+  if (s[0] != '0' || (s[1] != 'x' && s[1] != 'X'))
+    return atou32(s, value);
+
+  if (s[2] == '\0' || strlen(s) > 10)
+    return FALSE;
+  for (s += 2; *s; s++) {
+    if (*s >= '0' && *s <= '9')
+      digit = *s - '0';
+    else if ((*s | 0x20) >= 'a' && (*s | 0x20) <= 'f')
+      digit = (*s | 0x20) - 'a' + 10;
+    else
+      return FALSE;
+    v = (v << 4) | digit;
+  }
+  *value = v;
+  return TRUE;
+}
+
+static bool parse_args(U32 argc, char **argv, U32 *values) {
+  U32 i;
+
+  for (i = 1; i < argc; i++) {
+    if (!parse_number(argv[i], &values[i - 1])) {
+      nx_shell_printf("bad number: %s\n", argv[i]);
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+static S32 cmd_help(U32 argc __attribute__((unused)),
+                    char **argv __attribute__((unused))) {
+  U32 i;
+
+  for (i = 0; i < shell.command_count; i++)
+    nx_shell_printf("%-8s %s\n", shell.commands[i]->name,
+                    shell.commands[i]->help);
+  return 0;
+}
+
+static S32 cmd_uptime(U32 argc __attribute__((unused)),
+                      char **argv __attribute__((unused))) {
+  U32 ms = nx_systick_get_ms();
+
+  nx_shell_printf("%lu.%03lu s, cycle counter %lu\n",
+                  ms / 1000, ms % 1000, nx_systick_get_cycles());
+  return 0;
+}
+
+static S32 cmd_heap(U32 argc __attribute__((unused)),
+                    char **argv __attribute__((unused))) {
+  nx_shell_printf("heap %p-%p, %lu bytes\n", NX_USERSPACE_START,
+                  NX_USERSPACE_END, (U32)NX_USERSPACE_SIZE);
+  if (nx_memalloc_used)
+    nx_shell_printf("allocator: %lu bytes used\n", nx_memalloc_used());
+  else
+    nx_shell_printf("allocator not linked in\n");
+  return 0;
+}
+
+static S32 cmd_irq(U32 argc __attribute__((unused)),
+                   char **argv __attribute__((unused))) {
+  nx_aic_vector_t vector;
+  U32 i, count;
+
+  nx_shell_printf("vector  count\n");
+  for (i = 0; nx_aic_get_count(i, &vector, &count); i++)
+    nx_shell_printf("%6lu  %lu\n", vector, count);
+  nx_shell_printf("spurious %lu\n", nx_aic_get_spurious_count());
+  return 0;
+}
+
+static S32 cmd_stack(U32 argc __attribute__((unused)),
+                     char **argv __attribute__((unused))) {
+  U32 i, size, used;
+
+  nx_shell_printf("stack      size   used\n");
+  for (i = 0; i < NX_STACK_MAX; i++) {
+    size = nx_stack_size(i);
+    if (nx_stack_name(i) == NULL || size == 0)
+      continue;
+    used = nx_stack_high_water(i);
+    nx_shell_printf("%-8s %6lu %6lu %3lu%%\n", nx_stack_name(i), size, used,
+                    used * 100 / size);
+  }
+  return 0;
+}
+
+static S32 cmd_peek(U32 argc, char **argv) {
+  U32 args[2] = { 0, PEEK_COUNT };
+  volatile U32 *p;
+  U32 i;
+
+  if (argc < 2 || argc > 3 || !parse_args(argc, argv, args))
+    return -1;
+  if (args[0] & 3) {
+    nx_shell_printf("unaligned address\n");
+    return -1;
+  }
+
+  p = (volatile U32 *)args[0];
+  for (i = 0; i < args[1]; i++)
+    nx_shell_printf("%p: %08lx\n", (void *)&p[i], p[i]);
+  return 0;
+}
+
+static S32 cmd_poke(U32 argc, char **argv) {
+  U32 args[2];
+
+  if (argc != 3 || !parse_args(argc, argv, args))
+    return -1;
+  if (args[0] & 3) {
+    nx_shell_printf("unaligned address\n");
+    return -1;
+  }
+
+  *(volatile U32 *)args[0] = args[1];
+  return 0;
+}
+
+static S32 cmd_dump(U32 argc, char **argv) {
+  U32 args[2] = { 0, DUMP_LENGTH };
+  char ascii[17];
+  const U8 *p;
+  U32 i, j;
+
+  if (argc < 2 || argc > 3 || !parse_args(argc, argv, args))
+    return -1;
+
+  p = (const U8 *)args[0];
+  for (i = 0; i < args[1]; i += 16) {
+    nx_shell_printf("%p:", (void *)&p[i]);
+    for (j = 0; j < 16 && i + j < args[1]; j++) {
+      nx_shell_printf(" %02x", p[i + j]);
+      ascii[j] = (p[i + j] >= ' ' && p[i + j] < DEL) ? p[i + j] : '.';
+    }
+    ascii[j] = '\0';
+    nx_shell_printf("%*s  %s\n", (int)(16 - j) * 3, "", ascii);
+  }
+  return 0;
+}
+
+static void run_bench(const bench_t *bench, U32 runs) {
+  U32 i, start, cycles, min = 0xFFFFFFFF, max = 0, total = 0;
+
+  for (i = 0; i < runs; i++) {
+    start = nx_systick_get_cycles();
+    bench->fn();
+    cycles = nx_systick_get_cycles() - start;
+    min = MIN(min, cycles);
+    max = MAX(max, cycles);
+    total += cycles;
+  }
+  nx_shell_printf("%-16s %10lu %10lu %10lu\n", bench->name, min,
+                  total / runs, max);
+}
+
+static S32 cmd_bench(U32 argc, char **argv) {
+  U32 runs = BENCH_RUNS, i;
+  bool all, ran = FALSE;
+
+  if (argc == 1) {
+    for (i = 0; i < shell.bench_count; i++)
+      nx_shell_printf("%s\n", shell.benches[i].name);
+    return 0;
+  }
+  if (argc > 3 || (argc == 3 && (!parse_number(argv[2], &runs) || runs == 0)))
+    return -1;
+
+  all = streq(argv[1], "all");
+  nx_shell_printf("%-16s %10s %10s %10s\n", "cycles", "min", "avg", "max");
+  for (i = 0; i < shell.bench_count; i++) {
+    if (all || streq(argv[1], shell.benches[i].name)) {
+      run_bench(&shell.benches[i], runs);
+      ran = TRUE;
+    }
+  }
+  if (!ran)
+    nx_shell_printf("no benchmark %s\n", argv[1]);
+  return ran ? 0 : -1;
+}
+
+static const nx_shell_cmd_t builtins[] = {
+  { "bench", cmd_bench, "[NAME|all [RUNS]]  run benchmarks" },
+  { "dump", cmd_dump, "ADDR [LENGTH]  dump memory" },
+  { "heap", cmd_heap, "heap usage" },
+  { "help", cmd_help, "list the commands" },
+  { "irq", cmd_irq, "interrupt counts" },
+  { "peek", cmd_peek, "ADDR [COUNT]  read words" },
+  { "poke", cmd_poke, "ADDR VALUE  write a word" },
+  { "stack", cmd_stack, "stack high-water marks" },
+  { "uptime", cmd_uptime, "system time" },
+};
+
+/*
+ * Line handling.
+ */
+
+static void execute(void) {
+  char *argv[NX_SHELL_MAX_ARGS];
+  char *p = shell.line;
+  U32 argc = 0, i;
+  bool found;
+  S32 ret;
+
+  shell.line[shell.len] = '\0';
+  while (*p) {
+    while (*p == ' ')
+      *p++ = '\0';
+    if (*p == '\0')
+      break;
+    if (argc == NX_SHELL_MAX_ARGS) {
+      out_str("too many arguments\n");
+      return;
+    }
+    argv[argc++] = p;
+    while (*p && *p != ' ')
+      p++;
+  }
+  if (argc == 0)
+    return;
+
+  i = lookup(argv[0], &found);
+  if (!found) {
+    nx_shell_printf("%s: unknown command, try help\n", argv[0]);
+    return;
+  }
+  ret = shell.commands[i]->fn(argc, argv);
+  if (ret != 0)
+    nx_shell_printf("%s: error %ld (%s %s)\n", argv[0], ret,
+                    shell.commands[i]->name, shell.commands[i]->help);
+}
+
+static void history_add(void) {
+  char *last = shell.history[(shell.history_head - 1) % NX_SHELL_HISTORY];
+
+  shell.line[shell.len] = '\0';
+  if (shell.len == 0 || (shell.history_count > 0 && streq(last, shell.line)))
+    return;
+
+  memcpy(shell.history[shell.history_head % NX_SHELL_HISTORY], shell.line,
+         shell.len + 1);
+  shell.history_head++;
+  shell.history_count = MIN(shell.history_count + 1, NX_SHELL_HISTORY);
+}
+
+/* Show the line browse steps back in the history, 0 being an empty one. */
+static void history_show(U32 browse) {
+  const char *entry;
+
+  shell.browse = browse;
+  if (browse == 0) {
+    shell.len = 0;
+  } else {
+    entry = shell.history[(shell.history_head - browse) % NX_SHELL_HISTORY];
+    shell.len = strlen(entry);
+    memcpy(shell.line, entry, shell.len);
+  }
+  shell.cursor = shell.len;
+  redraw_line();
+}
+
+static void insert(char c) {
+  if (shell.len == NX_SHELL_LINE - 1)
+    return;
+  memmove(&shell.line[shell.cursor + 1], &shell.line[shell.cursor],
+          shell.len - shell.cursor);
+  shell.line[shell.cursor++] = c;
+  shell.len++;
+  out(&c, 1);
+  if (shell.cursor < shell.len)
+    redraw_tail();
+}
+
+/* Delete the character under the cursor. */
+static void delete(void) {
+  if (shell.cursor == shell.len)
+    return;
+  memmove(&shell.line[shell.cursor], &shell.line[shell.cursor + 1],
+          shell.len - shell.cursor - 1);
+  shell.len--;
+  redraw_tail();
+}
+
+/* Complete the command name, if the cursor ends the first word. */
+static void complete(void) {
+  U32 first, count = 0, common = 0, i;
+  bool found;
+  const char *name;
+
+  shell.line[shell.len] = '\0';
+  if (shell.cursor != shell.len || strchr(shell.line, ' ') != NULL)
+    return;
+
+  /* The matches follow each other in the sorted table. */
+  first = lookup(shell.line, &found);
+  for (i = first; i < shell.command_count; i++) {
+    name = shell.commands[i]->name;
+    if (!streqn(name, shell.line, shell.len))
+      break;
+    if (count == 0)
+      common = strlen(name);
+    else
+      while (!streqn(name, shell.commands[first]->name, common))
+        common--;
+    count++;
+  }
+  if (count == 0)
+    return;
+
+  name = shell.commands[first]->name;
+  for (i = shell.len; i < common; i++)
+    insert(name[i]);
+  if (count == 1) {
+    insert(' ');
+  } else if (common == shell.len) {
+    out_str("\n");
+    for (i = first; i < first + count; i++)
+      nx_shell_printf("%s ", shell.commands[i]->name);
+    out_str("\n");
+    redraw_line();
+  }
+}
+
+static void new_line(void) {
+  shell.len = shell.cursor = 0;
+  shell.browse = 0;
+  out_str(PROMPT);
+}
+
+static void escape(char c) {
+  if (c >= '0' && c <= '9') {
+    shell.csi_param = shell.csi_param * 10 + (c - '0');
+    return;
+  }
+  shell.input = INPUT_NORMAL;
+
+  switch (c) {
+    case 'A':
+      if (shell.browse < shell.history_count)
+        history_show(shell.browse + 1);
+      break;
+    case 'B':
+      if (shell.browse > 0)
+        history_show(shell.browse - 1);
+      break;
+    case 'C':
+      if (shell.cursor < shell.len) {
+        out_str("\x1b[C");
+        shell.cursor++;
+      }
+      break;
+    case 'D':
+      if (shell.cursor > 0) {
+        cursor_left(1);
+        shell.cursor--;
+      }
+      break;
+    case 'H':
+      cursor_left(shell.cursor);
+      shell.cursor = 0;
+      break;
+    case 'F':
+      out(&shell.line[shell.cursor], shell.len - shell.cursor);
+      shell.cursor = shell.len;
+      break;
+    case '~':
+      if (shell.csi_param == 1)
+        escape('H');
+      else if (shell.csi_param == 4)
+        escape('F');
+      else if (shell.csi_param == 3)
+        delete();
+      break;
+  }
+}
+
+static void input(char c) {
+  bool lf_of_crlf = shell.after_cr && c == '\n';
+
+  shell.after_cr = (c == '\r');
+  if (lf_of_crlf)
+    return;
+
+  switch (shell.input) {
+    case INPUT_ESC:
+      shell.input = (c == '[' || c == 'O') ? INPUT_CSI : INPUT_NORMAL;
+      shell.csi_param = 0;
+      return;
+    case INPUT_CSI:
+      escape(c);
+      return;
+    case INPUT_NORMAL:
+      break;
+  }
+
+  switch (c) {
+    case ESC:
+      shell.input = INPUT_ESC;
+      break;
+    case '\r':
+    case '\n':
+      out_str("\n");
+      history_add();
+      execute();
+      new_line();
+      break;
+    case DEL:
+    case '\b':
+      if (shell.cursor > 0) {
+        cursor_left(1);
+        shell.cursor--;
+        delete();
+      }
+      break;
+    case '\t':
+      complete();
+      break;
+    case CTRL('A'):
+      escape('H');
+      break;
+    case CTRL('E'):
+      escape('F');
+      break;
+    case CTRL('C'):
+      out_str("^C\n");
+      new_line();
+      break;
+    case CTRL('U'):
+      shell.len = shell.cursor = 0;
+      redraw_line();
+      break;
+    default:
+      if (c >= ' ')
+        insert(c);
+      break;
+  }
+}
+
+void nx_shell_poll(void) {
+  U8 buf[UART_RXBUFSIZE];
+  U32 n, i;
+
+  while ((n = nx_uart_port_read(shell.port, buf, sizeof(buf))) > 0) {
+    for (i = 0; i < n; i++)
+      input(buf[i]);
+  }
+}
+
+void nx_shell_init(nx_uart_port_t port) {
+  U32 i;
+
+  memset(&shell, 0, sizeof(shell));
+  shell.port = port;
+  for (i = 0; i < sizeof(builtins) / sizeof(builtins[0]); i++)
+    nx_shell_register(&builtins[i]);
+
+  nx_systick_install_idle(nx_shell_poll);
+  out_str("\nNxOS shell, type help for the commands.\n");
+  new_line();
+}
+
+#endif /* __DE1SOC__ */
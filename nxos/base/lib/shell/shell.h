@@ -0,0 +1,115 @@
+/** @file shell.h
+ *  @brief Diagnostic command shell over a UART.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_LIB_SHELL_H__
+#define __NXOS_BASE_LIB_SHELL_H__
+
+#include "base/types.h"
+#include "base/drivers/uart.h"
+
+#ifdef __DE1SOC__
+
+/** @addtogroup lib */
+/*@{*/
+
+/** @defgroup shell Diagnostic shell
+ *
+ * A command line on a JTAG UART, to inspect a running image without
+ * stopping it in a debugger. The shell runs from idle time (see
+ * nx_systick_idle()), so the application only has to wait or call
+ * nx_systick_idle() now and then.
+ *
+ * The line editor takes a VT100 terminal: left and right arrows, Home
+ * and End, Backspace and Delete, Ctrl-U to erase the line, Ctrl-C to
+ * cancel it, up and down arrows for the history, and Tab to complete
+ * command names.
+ *
+ * Commands are kept sorted by name, and looked up by binary search.
+ * The built-in commands are:
+ *
+ * - @c help: list the commands.
+ * - @c uptime: the system time.
+ * - @c heap: the heap size, and its use if the allocator is linked in.
+ * - @c irq: the number of interrupts dispatched to each handler.
+ * - @c stack: the stack high-water marks.
+ * - @c peek @c ADDR [@c COUNT]: read words.
+ * - @c poke @c ADDR @c VALUE: write a word.
+ * - @c dump @c ADDR [@c LENGTH]: dump bytes in hex and ASCII.
+ * - @c bench [@c NAME|@c all [@c RUNS]]: list or run the registered
+ *   benchmarks, and show their duration in system timer cycles.
+ *
+ * Numbers are decimal, or hexadecimal with a @c 0x prefix.
+ *
+ * @note Do not run the shell on the UART of the packet link.
+ */
+/*@{*/
+
+#define NX_SHELL_LINE 80 /**< Maximum line length. */
+#define NX_SHELL_HISTORY 8 /**< Lines kept in the history. */
+#define NX_SHELL_MAX_ARGS 8 /**< Maximum words on a line. */
+#define NX_SHELL_MAX_COMMANDS 32 /**< Maximum commands, built-ins included. */
+#define NX_SHELL_MAX_BENCHES 16 /**< Maximum registered benchmarks. */
+
+/** A command.
+ *
+ * @param argc The number of words on the line, the command included.
+ * @param argv The words.
+ * @return 0 on success. Other values are printed as an error.
+ */
+typedef S32 (*nx_shell_fn_t)(U32 argc, char **argv);
+
+/** @brief Description of a command. */
+typedef struct {
+  const char *name; /**< The command name. */
+  nx_shell_fn_t fn; /**< The command. */
+  const char *help; /**< A one line description, with the arguments. */
+} nx_shell_cmd_t;
+
+/** Start the shell, and add nx_shell_poll() to the idle callbacks.
+ *
+ * @param port The UART port of the shell.
+ */
+void nx_shell_init(nx_uart_port_t port);
+
+/** Add a command.
+ *
+ * @param cmd The command. It is not copied, and must stay valid.
+ * @return FALSE if the table is full or the name taken.
+ */
+bool nx_shell_register(const nx_shell_cmd_t *cmd);
+
+/** Add a benchmark for the @c bench command.
+ *
+ * @param name The benchmark name. It is not copied.
+ * @param fn The benchmark, run once per measure.
+ * @return FALSE if the table is full.
+ */
+bool nx_shell_register_bench(const char *name, nx_closure_t fn);
+
+/** Process the characters received. */
+void nx_shell_poll(void);
+
+/** Write formatted output on the shell UART.
+ *
+ * See nx_snprintf() for the format. The output is truncated to
+ * NX_PRINTF_BUFSIZE - 1 characters.
+ *
+ * @param fmt The format string.
+ */
+void nx_shell_printf(const char *fmt, ...)
+  __attribute__((format(printf, 1, 2)));
+
+/*@}*/
+/*@}*/
+
+#endif /* __DE1SOC__ */
+#endif /* __NXOS_BASE_LIB_SHELL_H__ */
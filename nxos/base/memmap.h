@@ -47,6 +47,12 @@ extern U8 __ram_userspace_end__;
 extern U8 __ramtext_ram_start__;
 extern U8 __ramtext_ram_end__;
 
+extern U8 __fast_ram_start__;
+extern U8 __fast_ram_end__;
+
+extern U8 __noinit_start__;
+extern U8 __noinit_end__;
+
 extern U8 __text_start__;
 extern U8 __text_end__;
 
@@ -101,6 +107,19 @@ extern U32 __bottom_mapped__;
 #define NX_RAMTEXT_SIZE SECSIZE(NX_RAMTEXT_START, NX_RAMTEXT_END)
 /*@}*/
 
+/** @name Fast section
+ *
+ * The fast section holds latency sensitive code and data (exception
+ * vectors, IRQ dispatch, hot ISRs). On the DE1-SoC it is copied at
+ * boot time into the A9 on-chip RAM, which does not compete with bulk
+ * DDR traffic.
+ */
+/*@{*/
+#define NX_FAST_START SYMADDR(__fast_ram_start__)
+#define NX_FAST_END SYMADDR(__fast_ram_end__)
+#define NX_FAST_SIZE SECSIZE(NX_FAST_START, NX_FAST_END)
+/*@}*/
+
 /** @name Text section
  *
  * The text section contains the executable code. It is usually placed
@@ -134,6 +153,17 @@ extern U32 __bottom_mapped__;
 #define NX_BSS_SIZE SECSIZE(NX_BSS_START, NX_BSS_END)
 /*@}*/
 
+/** @name No-init section
+ *
+ * The no-init section contains variables that are neither loaded nor
+ * zeroed out at startup, so that their contents survive a restart.
+ */
+/*@{*/
+#define NX_NOINIT_START SYMADDR(__noinit_start__)
+#define NX_NOINIT_END SYMADDR(__noinit_end__)
+#define NX_NOINIT_SIZE SECSIZE(NX_NOINIT_START, NX_NOINIT_END)
+/*@}*/
+
 /** @name Supervisor stack section.
  *
  * The Supervisor mode stack is the stack that is used when the kernel
@@ -197,6 +227,23 @@ extern U32 __bottom_mapped__;
 
 /** @endcond */
 
+/** @name Section placement attributes
+ *
+ * Tag a function (@a NX_FAST) or a variable (@a NX_FAST_DATA) to place
+ * it in the fast section. @a NX_NOINIT places a variable in the no-init
+ * section. Boards whose linker script has no dedicated fast memory
+ * simply keep these sections with the rest of the RAM image.
+ *
+ * @note On the DE1-SoC the fast section is out of @c BL range of the
+ * main text in DDR. The linker inserts long branch veneers for direct
+ * calls, but hand written assembler must use absolute jumps.
+ */
+/*@{*/
+#define NX_FAST __attribute__((section(".fast"), noinline))
+#define NX_FAST_DATA __attribute__((section(".fast.data")))
+#define NX_NOINIT __attribute__((section(".noinit")))
+/*@}*/
+
 /*@}*/
 /*@}*/
 
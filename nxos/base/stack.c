@@ -0,0 +1,196 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#include "base/types.h"
+#include "base/interrupts.h"
+#include "base/drivers/systick.h"
+
+#include "base/_stack.h"
+
+/* The privileged mode stack boundaries, defined by the linker
+ * script. Each stack spans from its bottom symbol to its top (initial
+ * stack pointer) symbol.
+ */
+extern U8 __supervisor_stack_bottom__;
+extern U8 __supervisor_stack__;
+extern U8 __abort_stack_bottom__;
+extern U8 __abort_stack__;
+#ifdef __DE1SOC__
+extern U8 __irq_stack_bottom__;
+extern U8 __irq_stack__;
+extern U8 __und_stack_bottom__;
+extern U8 __und_stack__;
+#endif
+
+typedef struct {
+  const char *name;
+  U32 *bottom;
+  U32 *top;
+} stack_region_t;
+
+static stack_region_t stacks[NX_STACK_MAX] = {
+  { "svc", (U32*)&__supervisor_stack_bottom__, (U32*)&__supervisor_stack__ },
+#ifdef __DE1SOC__
+  { "irq", (U32*)&__irq_stack_bottom__, (U32*)&__irq_stack__ },
+  { "abt", (U32*)&__abort_stack_bottom__, (U32*)&__abort_stack__ },
+  { "und", (U32*)&__und_stack_bottom__, (U32*)&__und_stack__ },
+#endif
+#ifdef __LEGONXT__
+  /* The IRQ and SYS stacks share the top of RAM with userspace. */
+  { "irq", NULL, NULL },
+  { "abt", (U32*)&__abort_stack_bottom__, (U32*)&__abort_stack__ },
+  { "und", NULL, NULL },
+#endif
+};
+
+static volatile struct {
+  /* Check interval and countdown to the next check, in milliseconds. */
+  U32 interval;
+  U32 countdown;
+  nx_stack_overflow_handler_t handler;
+
+  /* Bitmask of the stacks already reported as overflowed. */
+  U32 reported;
+
+  /* First overflow detected. */
+  bool overflowed;
+  nx_stack_overflow_t first;
+} check = {
+  0, 0, NULL, 0, FALSE, { 0, NULL, 0 }
+};
+
+/* Return the lowest word of the region that does not hold the paint
+ * pattern, or top if the region is untouched.
+ */
+static U32 *lowest_used(U32 *bottom, U32 *top) {
+  U32 *p = bottom;
+
+  while (p < top && *p == NX__STACK_PAINT_VAL)
+    p++;
+
+  return p;
+}
+
+static inline bool stack_valid(U32 stack) {
+  return stack < NX_STACK_MAX && stacks[stack].bottom != NULL;
+}
+
+const char *nx_stack_name(U32 stack) {
+  if (!stack_valid(stack))
+    return NULL;
+
+  return stacks[stack].name;
+}
+
+U32 nx_stack_size(U32 stack) {
+  if (!stack_valid(stack))
+    return 0;
+
+  return (U32)stacks[stack].top - (U32)stacks[stack].bottom;
+}
+
+U32 nx_stack_high_water(U32 stack) {
+  U32 *lowest;
+
+  if (!stack_valid(stack))
+    return 0;
+
+  lowest = lowest_used(stacks[stack].bottom, stacks[stack].top);
+  return (U32)stacks[stack].top - (U32)lowest;
+}
+
+S32 nx_stack_register(const char *name, U8 *bottom, U32 size) {
+  U32 *p, *top;
+  S32 i;
+
+  top = (U32*)(((U32)bottom + size) & ~3);
+  bottom = (U8*)(((U32)bottom + 3) & ~3);
+
+  for (p = (U32*)bottom; p < top; p++)
+    *p = NX__STACK_PAINT_VAL;
+
+  nx_interrupts_disable();
+  for (i = NX_STACK_MODES; i < NX_STACK_MAX; i++) {
+    if (stacks[i].bottom == NULL) {
+      stacks[i].name = name;
+      stacks[i].top = top;
+      stacks[i].bottom = (U32*)bottom;
+      check.reported &= ~(1 << i);
+      break;
+    }
+  }
+  nx_interrupts_enable();
+
+  return i < NX_STACK_MAX ? i : -1;
+}
+
+void nx_stack_unregister(U32 stack) {
+  if (stack < NX_STACK_MODES || stack >= NX_STACK_MAX)
+    return;
+
+  nx_interrupts_disable();
+  stacks[stack].bottom = NULL;
+  stacks[stack].top = NULL;
+  stacks[stack].name = NULL;
+  nx_interrupts_enable();
+}
+
+void nx_stack_set_check(U32 interval_ms, nx_stack_overflow_handler_t handler) {
+  nx_interrupts_disable();
+  check.handler = handler;
+  check.interval = interval_ms;
+  check.countdown = interval_ms;
+  nx_interrupts_enable();
+}
+
+bool nx_stack_get_overflow(nx_stack_overflow_t *overflow) {
+  if (!check.overflowed)
+    return FALSE;
+
+  overflow->stack = check.first.stack;
+  overflow->addr = check.first.addr;
+  overflow->ms = check.first.ms;
+  return TRUE;
+}
+
+void nx__stack_check(void) {
+  nx_stack_overflow_t overflow;
+  U32 i, guard_end;
+  U32 *addr;
+
+  if (check.interval == 0 || --check.countdown > 0)
+    return;
+  check.countdown = check.interval;
+
+  for (i = 0; i < NX_STACK_MAX; i++) {
+    if (stacks[i].bottom == NULL || (check.reported & (1 << i)))
+      continue;
+
+    /* Only the guard band is scanned here, to keep the cost bounded. */
+    guard_end = (U32)stacks[i].bottom + NX_STACK_GUARD_SIZE;
+    if (guard_end > (U32)stacks[i].top)
+      guard_end = (U32)stacks[i].top;
+
+    addr = lowest_used(stacks[i].bottom, (U32*)guard_end);
+    if (addr == (U32*)guard_end)
+      continue;
+
+    overflow.stack = i;
+    overflow.addr = (U8*)addr;
+    overflow.ms = nx_systick_get_ms();
+
+    check.reported |= (1 << i);
+    if (!check.overflowed) {
+      check.first = overflow;
+      check.overflowed = TRUE;
+    }
+
+    if (check.handler)
+      check.handler(&overflow);
+  }
+}
@@ -0,0 +1,144 @@
+/** @file stack.h
+ *  @brief Stack usage measurement and overflow detection.
+ */
+
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+#ifndef __NXOS_BASE_STACK_H__
+#define __NXOS_BASE_STACK_H__
+
+#include "base/types.h"
+
+/** @addtogroup kernel */
+/*@{*/
+
+/** @defgroup stack Stack usage
+ *
+ * At boot time, the privileged mode stacks are painted with a known
+ * pattern (on the DE1-SoC only, the NXT startup code zeroes them). The
+ * high-water mark of a stack is then found by looking for the lowest
+ * word that no longer holds the pattern, which gives the deepest stack
+ * usage since boot.
+ *
+ * Application kernels can register their own task stacks, so that
+ * they get measured and checked the same way.
+ *
+ * Optionally, the systick interrupt handler checks periodically the
+ * guard band at the bottom of every registered stack. The first time a
+ * stack is found to have reached its guard band, the overflow is
+ * recorded, and handed over to an optional handler.
+ *
+ * @note Stack sizes are set in the board linker script, and can be
+ * overridden at link time (eg. @c --defsym=ABT_STACK_SIZE=1024 on the
+ * DE1-SoC). Use the high-water marks to size them tightly.
+ */
+/*@{*/
+
+/** @name Privileged mode stacks
+ *
+ * Identifiers of the stacks that are always known to the kernel. Stacks
+ * that do not exist on a given board report a size of 0.
+ */
+/*@{*/
+#define NX_STACK_SVC 0 /**< Supervisor mode stack. */
+#define NX_STACK_IRQ 1 /**< IRQ mode stack. */
+#define NX_STACK_ABT 2 /**< Abort mode stack. */
+#define NX_STACK_UND 3 /**< Undefined instruction mode stack. */
+#define NX_STACK_MODES 4 /**< Number of privileged mode stacks. */
+/*@}*/
+
+/** Maximum number of task stacks that can be registered. */
+#define NX_STACK_MAX_TASKS 8
+
+/** Total number of stack slots (mode stacks and task stacks). */
+#define NX_STACK_MAX (NX_STACK_MODES + NX_STACK_MAX_TASKS)
+
+/** Size in bytes of the guard band at the bottom of each stack. A
+ * stack is considered overflowed as soon as it is used into its guard
+ * band.
+ */
+#define NX_STACK_GUARD_SIZE 32
+
+/** @brief Description of a detected stack overflow. */
+typedef struct {
+  U32 stack; /**< Identifier of the overflowed stack. */
+  U8 *addr; /**< Lowest stack address found modified. */
+  U32 ms; /**< System time of the detection, in milliseconds. */
+} nx_stack_overflow_t;
+
+/** Stack overflow handler.
+ *
+ * @param overflow The overflow information.
+ *
+ * @warning This is called from the systick interrupt handler, and must
+ * be kept short.
+ */
+typedef void (*nx_stack_overflow_handler_t)(const nx_stack_overflow_t *overflow);
+
+/** Return the name of a stack.
+ *
+ * @param stack The stack identifier.
+ * @return The stack name, or NULL if the slot is unused.
+ */
+const char *nx_stack_name(U32 stack);
+
+/** Return the size of a stack.
+ *
+ * @param stack The stack identifier.
+ * @return The size in bytes, or 0 if the slot is unused.
+ */
+U32 nx_stack_size(U32 stack);
+
+/** Return the high-water mark of a stack.
+ *
+ * @param stack The stack identifier.
+ * @return The maximum number of bytes used since the stack was painted.
+ *
+ * @note The cost is proportional to the unused part of the stack.
+ */
+U32 nx_stack_high_water(U32 stack);
+
+/** Register a task stack for measurement and overflow checks.
+ *
+ * The stack is painted by this call, so it must be registered before
+ * the task starts running on it.
+ *
+ * @param name The name of the stack (not copied).
+ * @param bottom The lowest address of the stack, word aligned.
+ * @param size The size of the stack in bytes.
+ * @return The stack identifier, or -1 if no slot is left.
+ */
+S32 nx_stack_register(const char *name, U8 *bottom, U32 size);
+
+/** Unregister a task stack.
+ *
+ * @param stack The identifier returned by nx_stack_register().
+ */
+void nx_stack_unregister(U32 stack);
+
+/** Set up the periodic stack overflow check.
+ *
+ * @param interval_ms The check interval in milliseconds, 0 to disable
+ * the check.
+ * @param handler An optional handler, called once for each overflowed
+ * stack. May be NULL.
+ */
+void nx_stack_set_check(U32 interval_ms, nx_stack_overflow_handler_t handler);
+
+/** Retrieve the first stack overflow detected by the periodic check.
+ *
+ * @param overflow Filled in with the overflow information, if any.
+ * @return TRUE if an overflow was detected, FALSE otherwise.
+ */
+bool nx_stack_get_overflow(nx_stack_overflow_t *overflow);
+
+/*@}*/
+/*@}*/
+
+#endif /* __NXOS_BASE_STACK_H__ */
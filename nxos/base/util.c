@@ -11,6 +11,16 @@
 #include "base/assert.h"
 #include "base/_memcpy.h"
 
+#define WORD_MASK (sizeof(U32) - 1)
+
+/* Word type used to scan byte buffers a word at a time. */
+typedef U32 __attribute__((may_alias)) word_t;
+
+/* Word-at-a-time zero byte detection: non zero if any of the 4 bytes
+ * of x is zero.
+ */
+#define HAS_ZERO_BYTE(x) (((x) - 0x01010101UL) & ~(x) & 0x80808080UL)
+
 void memmove(void *dest, const void *source, U32 len) {
   U8 *dst = (U8*)dest;
   U8 *src = (U8*)source;
@@ -21,12 +31,24 @@ void memmove(void *dest, const void *source, U32 len) {
   if(dst == src) {
      // Nothing to copy!
   } else if(src > dst) {
-    while (len--) {
-      *dst++ = *src++;
-    }
+    /* The forward copy reads ahead of its writes, so this is safe. */
+    nx__memcpy_ram(dst, src, len);
   } else {
     dst = dst + len;
     src = src + len;
+
+    if (len >= NX__MEMOPS_SMALL) {
+      while ((U32)dst & WORD_MASK) {
+        *--dst = *--src;
+        len--;
+      }
+
+      if (((U32)src & WORD_MASK) == 0) {
+        nx__memcpy_words_back(dst, src, len);
+        return;
+      }
+    }
+
     while (len--) {
       *--dst = *--src;
     }
@@ -42,20 +64,41 @@ void memset(void *dest, const U8 val, U32 len) {
 
   NX_ASSERT(dst != NULL);
 
+  if (len >= NX__MEMOPS_SMALL) {
+    while ((U32)dst & WORD_MASK) {
+      *dst++ = val;
+      len--;
+    }
+
+    nx__memset_words(dst, val * 0x01010101UL, len);
+    return;
+  }
+
   while (len--) {
     *dst++ = val;
   }
 }
 
 U32 strlen(const char *str) {
-  U32 i = 0;
+  const char *s = str;
+  const word_t *w;
 
   NX_ASSERT(str != NULL);
 
-  while (*str++)
-    i++;
+  while ((U32)s & WORD_MASK) {
+    if (*s == '\0')
+      return s - str;
+    s++;
+  }
 
-  return i;
+  /* Aligned word reads never cross a page, so reading past the
+   * terminator is harmless.
+   */
+  for (w = (const word_t*)s; !HAS_ZERO_BYTE(*w); w++);
+
+  for (s = (const char*)w; *s; s++);
+
+  return s - str;
 }
 
 bool streqn(const char *a, const char *b, U32 n) {
@@ -72,8 +115,34 @@ bool streqn(const char *a, const char *b, U32 n) {
 }
 
 bool streq(const char *a, const char *b) {
+  const word_t *wa, *wb;
+
   NX_ASSERT(a != NULL && b != NULL);
 
+  /* If both strings share the same alignment, compare a word at a time
+   * up to the first differing word or the first word holding the
+   * terminator, then finish byte by byte.
+   */
+  if ((((U32)a ^ (U32)b) & WORD_MASK) == 0) {
+    while ((U32)a & WORD_MASK) {
+      if (*a != *b)
+        return FALSE;
+      if (*a == '\0')
+        return TRUE;
+      a++;
+      b++;
+    }
+
+    wa = (const word_t*)a;
+    wb = (const word_t*)b;
+    while (*wa == *wb && !HAS_ZERO_BYTE(*wa)) {
+      wa++;
+      wb++;
+    }
+    a = (const char*)wa;
+    b = (const char*)wb;
+  }
+
   while (*a != '\0' && *b != '\0') {
     if (*a++ != *b++)
       return FALSE;
@@ -83,8 +152,25 @@ bool streq(const char *a, const char *b) {
 }
 
 char *strchr(const char *s, const char c) {
+  const U32 pattern = (U8)c * 0x01010101UL;
+  const word_t *w;
+
   NX_ASSERT(s != NULL);
 
+  while ((U32)s & WORD_MASK) {
+    if (*s == '\0')
+      return NULL;
+    if (*s == c)
+      return (char*)s;
+    s++;
+  }
+
+  /* Skip whole words holding neither the terminator nor c. */
+  for (w = (const word_t*)s;
+       !HAS_ZERO_BYTE(*w) && !HAS_ZERO_BYTE(*w ^ pattern);
+       w++);
+  s = (const char*)w;
+
   while (*s) {
     if (*s == c)
       return (char*)s;
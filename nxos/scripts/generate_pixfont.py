@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+#
+# "Compile" a font image into a C include file containing the glyphs
+# as row masks, the packed format used to render text into the pixel
+# framebuffer (base/lib/gfx).
+#
+# Each glyph is FONT_HEIGHT bytes, one per pixel row from the top. Bit
+# x of a row is set if pixel x of that row, counted from the left, is
+# drawn.
+#
+
+import sys
+
+try:
+    from PIL import Image
+except ImportError:
+    print("ERROR: Python Imaging Library required for font generation.")
+    sys.exit(2)
+
+
+class Font(object):
+    def __init__(self, font_file):
+        # Extract the character size from the filename
+        size = font_file.split('.')[-2]
+        y, x = size.split('x')
+        try:
+            self.charx = int(x)
+            self.chary = int(y)
+            if self.charx > 8:
+                raise ValueError
+        except ValueError:
+            print("ERROR: unparseable font size %s" % size)
+            sys.exit(1)
+
+        # Open the image and check that its dimensions make sense
+        self.img = Image.open(font_file).convert('1')
+
+        if ((self.img.size[0] % self.charx) != 0 or
+                (self.img.size[1] % self.chary) != 0):
+            print("ERROR: Font image for %s font has non-multiple dimensions" % size)
+            sys.exit(1)
+
+        # Remember how many font char rows and cols there are
+        self.rows = self.img.size[1] // self.chary
+        self.cols = self.img.size[0] // self.charx
+
+    def _row_mask(self, left, y):
+        mask = 0
+        for x in range(self.charx):
+            # Black pixels are drawn.
+            if not self.img.getpixel((left + x, y)):
+                mask |= 1 << x
+        return mask
+
+    def chars(self):
+        for row in range(self.rows):
+            for col in range(self.cols):
+                left = col * self.charx
+                top = row * self.chary
+                yield [self._row_mask(left, top + y) for y in range(self.chary)]
+
+
+def main():
+    if len(sys.argv) != 4:
+        print("Usage: %s <font file> <template file> <output file>" % sys.argv[0])
+        sys.exit(1)
+
+    font_file, template_file, output_file = sys.argv[1:]
+
+    font = Font(font_file)
+
+    font_chars = []
+    for rows in font.chars():
+        font_chars.append(', '.join(['0x%02X' % r for r in rows]))
+    font_data = '\n  '.join(['{ %s },' % c for c in font_chars])
+
+    with open(template_file) as f:
+        template = f.read()
+
+    template = template.replace('@@FONT_WIDTH@@', '%d' % font.charx)
+    template = template.replace('@@FONT_HEIGHT@@', '%d' % font.chary)
+    template = template.replace('@@FONT_GLYPHS@@', '%d' % len(font_chars))
+    template = template.replace('@@FONT_DATA@@', font_data)
+
+    with open(output_file, 'w') as f:
+        f.write(template)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,377 @@
+#!/usr/bin/env python3
+#
+# Host side of the NxOS packet link (base/lib/link), and client of the
+# linkmem memory server (systems/examples/linkmem).
+#
+# Usage:
+#   nxlink.py [--tcp host:port | --device path] upload ADDR FILE
+#   nxlink.py [...] download ADDR LENGTH FILE
+#   nxlink.py [...] crc ADDR LENGTH
+#   nxlink.py [...] monitor [--show PORT]...
+#
+# monitor prints the console channel of base/lib/mux to stdout, and
+# counts the packets of the other channels, printing those of the
+# ports given with --show in hex, until interrupted.
+#
+# Addresses and lengths may be given in hex with a 0x prefix. Without a
+# device, the link runs over stdin and stdout.
+#
+
+import argparse
+import os
+import select
+import socket
+import struct
+import sys
+import time
+import zlib
+
+MTU = 256
+WINDOW = 4
+RTO = 0.2
+
+DATA, ACK, SYNC = 1, 2, 3
+RELIABLE, REPLY = 1, 2
+
+LINKMEM_PORT = 1
+CONSOLE_PORT = 0
+REQ_HEADER = 9
+REPLY_HEADER = REQ_HEADER + 1
+MAX_READ = MTU - REPLY_HEADER
+MAX_WRITE = MTU - REQ_HEADER
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_pos, code = 0, 1
+    for b in data:
+        if b == 0:
+            out[code_pos] = code
+            code_pos, code = len(out), 1
+            out.append(0)
+        else:
+            out.append(b)
+            code += 1
+            if code == 0xFF:
+                out[code_pos] = code
+                code_pos, code = len(out), 1
+                out.append(0)
+    out[code_pos] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(data):
+            raise ValueError("bad COBS block")
+        out += data[i:i + code - 1]
+        i += code - 1
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class LinkError(Exception):
+    pass
+
+
+class Link(object):
+    """Go-back-N packet link, the mirror of base/lib/link/link.c."""
+
+    def __init__(self, read_fd, write):
+        self.read_fd = read_fd
+        self.write = write
+        self.frame = bytearray()
+        self.received = []
+        self.tx_base = self.tx_next = 0
+        self.window = {}
+        self.timer = 0
+        self.rx_expected = 0
+        self.synced = False
+        self.retransmits = 0
+        self.errors = 0
+
+    def send_packet(self, type_, flags, seq, port, data=b''):
+        packet = struct.pack('<BBBB', type_, flags, seq & 0xFF, port) + data
+        packet += struct.pack('<I', zlib.crc32(packet) & 0xFFFFFFFF)
+        self.write(cobs_encode(packet) + b'\0')
+
+    def sync(self, timeout=5.0):
+        deadline = time.monotonic() + timeout
+        while not self.synced:
+            self.send_packet(SYNC, 0, 0, 0)
+            end = min(deadline, time.monotonic() + 0.5)
+            while not self.synced and time.monotonic() < end:
+                self.poll(0.05)
+            if time.monotonic() >= deadline:
+                raise LinkError("no answer from the target")
+
+    def send(self, port, data, reliable=True):
+        if len(data) > MTU:
+            raise LinkError("payload too large")
+        if not reliable:
+            self.send_packet(DATA, 0, 0, port, data)
+            return
+        while self.tx_next - self.tx_base >= WINDOW:
+            self.poll(0.05)
+        seq = self.tx_next
+        self.window[seq] = (port, bytes(data))
+        if self.tx_base == self.tx_next:
+            self.timer = time.monotonic()
+        self.send_packet(DATA, RELIABLE, seq, port, data)
+        self.tx_next += 1
+
+    def recv(self, timeout=5.0):
+        deadline = time.monotonic() + timeout
+        while not self.received:
+            left = deadline - time.monotonic()
+            if left <= 0:
+                raise LinkError("timeout")
+            self.poll(min(left, 0.05))
+        return self.received.pop(0)
+
+    def flush(self, timeout=5.0):
+        deadline = time.monotonic() + timeout
+        while self.tx_base != self.tx_next:
+            if time.monotonic() >= deadline:
+                raise LinkError("timeout")
+            self.poll(0.05)
+
+    def poll(self, timeout):
+        ready, _, _ = select.select([self.read_fd], [], [], timeout)
+        if ready:
+            data = os.read(self.read_fd, 4096)
+            if not data:
+                raise LinkError("connection closed")
+            for b in data:
+                if b:
+                    self.frame.append(b)
+                elif self.frame:
+                    self.handle_frame(bytes(self.frame))
+                    self.frame.clear()
+
+        if self.tx_base != self.tx_next and time.monotonic() - self.timer >= RTO:
+            for seq in range(self.tx_base, self.tx_next):
+                port, data = self.window[seq]
+                self.send_packet(DATA, RELIABLE, seq, port, data)
+                self.retransmits += 1
+            self.timer = time.monotonic()
+
+    def handle_frame(self, frame):
+        try:
+            packet = cobs_decode(frame)
+        except ValueError:
+            self.errors += 1
+            return
+        if len(packet) < 8:
+            self.errors += 1
+            return
+        body, crc = packet[:-4], struct.unpack('<I', packet[-4:])[0]
+        if zlib.crc32(body) & 0xFFFFFFFF != crc:
+            self.errors += 1
+            return
+
+        type_, flags, seq, port = body[:4]
+        data = body[4:]
+        if type_ == DATA:
+            if not flags & RELIABLE:
+                self.received.append((port, data))
+            elif seq == self.rx_expected & 0xFF:
+                self.received.append((port, data))
+                self.send_packet(ACK, 0, seq, 0)
+                self.rx_expected += 1
+            else:
+                self.send_packet(ACK, 0, (self.rx_expected - 1) & 0xFF, 0)
+        elif type_ == ACK:
+            # Map the 8-bit number back into the window.
+            offset = (seq - self.tx_base) & 0xFF
+            if offset < self.tx_next - self.tx_base:
+                for s in range(self.tx_base, self.tx_base + offset + 1):
+                    del self.window[s]
+                self.tx_base += offset + 1
+                self.timer = time.monotonic()
+        elif type_ == SYNC:
+            self.rx_expected = seq
+            if flags & REPLY:
+                self.synced = True
+            else:
+                self.tx_base = self.tx_next = 0
+                self.window.clear()
+                self.send_packet(SYNC, REPLY, 0, 0)
+
+
+class Memory(object):
+    """Client of the linkmem memory server."""
+
+    def __init__(self, link):
+        self.link = link
+
+    def request(self, op, addr, length, data=b''):
+        self.link.send(LINKMEM_PORT,
+                       struct.pack('<BII', ord(op), addr, length) + data)
+
+    def reply(self, op):
+        while True:
+            port, data = self.link.recv()
+            if port == LINKMEM_PORT:
+                break
+        rop, addr, length, status = struct.unpack('<BIIB', data[:REPLY_HEADER])
+        if rop != ord(op) | 0x80 or status != 0:
+            raise LinkError("request %s at 0x%08x failed (status %d)"
+                            % (op, addr, status))
+        return addr, data[REPLY_HEADER:]
+
+    def read(self, addr, length, progress=None):
+        chunks = [(a, min(MAX_READ, addr + length - a))
+                  for a in range(addr, addr + length, MAX_READ)]
+        result = {}
+        pending = 0
+        # Keep a window of requests in flight: replies come in order.
+        for a, n in chunks:
+            self.request('R', a, n)
+            pending += 1
+            while pending >= WINDOW:
+                ra, data = self.reply('R')
+                result[ra] = data
+                pending -= 1
+                if progress:
+                    progress(len(result) * MAX_READ)
+        while pending:
+            ra, data = self.reply('R')
+            result[ra] = data
+            pending -= 1
+        return b''.join(result[a] for a, n in chunks)
+
+    def write(self, addr, data, progress=None):
+        pending = 0
+        for off in range(0, len(data), MAX_WRITE):
+            chunk = data[off:off + MAX_WRITE]
+            self.request('W', addr + off, len(chunk), chunk)
+            pending += 1
+            while pending >= WINDOW:
+                self.reply('W')
+                pending -= 1
+                if progress:
+                    progress(off)
+        while pending:
+            self.reply('W')
+            pending -= 1
+
+    def crc(self, addr, length):
+        self.request('C', addr, length)
+        return struct.unpack('<I', self.reply('C')[1][:4])[0]
+
+
+def open_link(args):
+    if args.tcp:
+        host, port = args.tcp.rsplit(':', 1)
+        sock = socket.create_connection((host, int(port)))
+        return Link(sock.fileno(), sock.sendall)
+    if args.device:
+        fd = os.open(args.device, os.O_RDWR | os.O_NOCTTY)
+        def write(data):
+            while data:
+                data = data[os.write(fd, data):]
+        return Link(fd, write)
+    out = sys.stdout.buffer
+    def write(data):
+        out.write(data)
+        out.flush()
+    return Link(sys.stdin.fileno(), write)
+
+
+def number(s):
+    return int(s, 0)
+
+
+def monitor(link, show):
+    counts = {}
+    try:
+        while True:
+            try:
+                port, data = link.recv(timeout=1.0)
+            except LinkError as e:
+                if str(e) == "timeout":
+                    continue
+                raise
+            if port == CONSOLE_PORT:
+                sys.stdout.write(data.decode('latin-1'))
+                sys.stdout.flush()
+                continue
+            packets, size = counts.get(port, (0, 0))
+            counts[port] = (packets + 1, size + len(data))
+            if port in show:
+                sys.stderr.write("[%d] %s\n" % (port, data.hex(' ')))
+    except KeyboardInterrupt:
+        pass
+    for port in sorted(counts):
+        sys.stderr.write("nxlink: port %d: %d packets, %d bytes\n"
+                         % ((port,) + counts[port]))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Move memory regions to and from an NxOS target.")
+    parser.add_argument('--tcp', metavar='HOST:PORT',
+                        help="reach the UART through a TCP connection")
+    parser.add_argument('--device', metavar='PATH',
+                        help="reach the UART through a device or pty")
+    sub = parser.add_subparsers(dest='command', required=True)
+    p = sub.add_parser('upload', help="write a file to target memory")
+    p.add_argument('addr', type=number)
+    p.add_argument('file')
+    p = sub.add_parser('download', help="read target memory to a file")
+    p.add_argument('addr', type=number)
+    p.add_argument('length', type=number)
+    p.add_argument('file')
+    p = sub.add_parser('crc', help="compute the CRC-32 of target memory")
+    p.add_argument('addr', type=number)
+    p.add_argument('length', type=number)
+    p = sub.add_parser('monitor', help="print the console and count channels")
+    p.add_argument('--show', metavar='PORT', type=number, action='append',
+                   default=[], help="print the packets of PORT in hex")
+    args = parser.parse_args()
+
+    link = open_link(args)
+    link.sync()
+    if args.command == 'monitor':
+        monitor(link, args.show)
+        return
+    mem = Memory(link)
+    start = time.monotonic()
+
+    try:
+        if args.command == 'upload':
+            with open(args.file, 'rb') as f:
+                data = f.read()
+            mem.write(args.addr, data)
+            link.flush()
+            if mem.crc(args.addr, len(data)) != zlib.crc32(data) & 0xFFFFFFFF:
+                raise LinkError("CRC mismatch after upload")
+            size = len(data)
+        elif args.command == 'download':
+            data = mem.read(args.addr, args.length)
+            with open(args.file, 'wb') as f:
+                f.write(data)
+            size = len(data)
+        else:
+            print("0x%08x" % mem.crc(args.addr, args.length))
+            size = 0
+    except LinkError as e:
+        sys.stderr.write("nxlink: %s\n" % e)
+        sys.exit(1)
+
+    elapsed = time.monotonic() - start
+    if size:
+        sys.stderr.write("nxlink: %d bytes in %.2f s (%.0f bytes/s), "
+                         "%d retransmits, %d bad frames\n"
+                         % (size, elapsed, size / max(elapsed, 1e-6),
+                            link.retransmits, link.errors))
+
+
+if __name__ == '__main__':
+    main()
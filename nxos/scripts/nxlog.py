@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+#
+# Decode the binary kernel log of NxOS (base/lib/log, built with
+# LOGBIN=1), using the call site descriptions kept in the .nxlog.fmt
+# section of the ELF file.
+#
+# Usage: nxlog.py ELF [--tcp host:port | path]
+#
+# Without a source, the UART output is read from stdin. Bytes that are
+# not part of a frame are ignored.
+#
+
+import argparse
+import os
+import socket
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from nxlink import cobs_decode  # noqa: E402
+
+ID_TEXT = 0xFFFF
+ID_DROPPED = 0xFFFE
+
+LEVELS = "EWID"
+
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+
+
+class Elf(object):
+    """The sections of a little endian ELF file, 32 or 64 bit."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF' or self.data[5] != 1:
+            raise ValueError("%s: not a little endian ELF file" % path)
+        is64 = self.data[4] == 2
+        if is64:
+            shoff, = struct.unpack_from('<Q', self.data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from('<HHH', self.data, 0x3A)
+            fmt = '<IIQQQQIIQQ'
+        else:
+            shoff, = struct.unpack_from('<I', self.data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from('<HHH', self.data, 0x2E)
+            fmt = '<IIIIIIIIII'
+
+        headers = [struct.unpack_from(fmt, self.data, shoff + i * shentsize)
+                   for i in range(shnum)]
+        names = headers[shstrndx]
+        self.sections = {}
+        for h in headers:
+            name_off, type_, flags, addr, offset, size = h[:6]
+            name = self.cstring(names[4] + name_off)
+            content = (b'' if type_ == SHT_NOBITS
+                       else self.data[offset:offset + size])
+            self.sections[name] = (type_, flags, addr, content)
+
+    def cstring(self, offset, data=None):
+        data = self.data if data is None else data
+        end = data.index(b'\0', offset)
+        return data[offset:end].decode('latin-1')
+
+    def string_at(self, addr):
+        """The string constant at a target address, or None."""
+        for type_, flags, start, content in self.sections.values():
+            if (flags & SHF_ALLOC and type_ != SHT_NOBITS
+                    and start <= addr < start + len(content)):
+                try:
+                    return self.cstring(addr - start, content)
+                except ValueError:
+                    return None
+        return None
+
+
+class Site(object):
+    """A call site, as described in .nxlog.fmt."""
+
+    def __init__(self, fmt_section, offset, elf):
+        self.level, self.nargs, self.line = struct.unpack_from(
+            '<BBH', fmt_section, offset)
+        self.format = elf.cstring(offset + 4, fmt_section)
+        self.file = elf.cstring(offset + 4 + len(self.format) + 1, fmt_section)
+
+
+def format_message(fmt, args, elf):
+    """Apply an nx_snprintf() format string to raw 32 bit arguments."""
+    out = []
+    args = list(args)
+    i = 0
+
+    def next_arg():
+        return args.pop(0) if args else 0
+
+    while i < len(fmt):
+        c = fmt[i]
+        i += 1
+        if c != '%':
+            out.append(c)
+            continue
+        flags = ''
+        while i < len(fmt) and fmt[i] in '-0':
+            flags += fmt[i]
+            i += 1
+        if i < len(fmt) and fmt[i] == '*':
+            width = next_arg()
+            if width & 0x80000000:
+                width = (1 << 32) - width
+                flags += '-'
+            width = str(width)
+            i += 1
+        else:
+            start = i
+            while i < len(fmt) and fmt[i].isdigit():
+                i += 1
+            width = fmt[start:i]
+        if i < len(fmt) and fmt[i] == 'l':
+            i += 1
+        if i >= len(fmt):
+            out.append('%' + flags + width)
+            break
+        conv = fmt[i]
+        i += 1
+        spec = '%' + flags + width
+        if conv in 'di':
+            v = next_arg()
+            out.append((spec + 'd') % (v - (1 << 32) if v & 0x80000000 else v))
+        elif conv in 'uxX':
+            out.append((spec + conv.replace('u', 'd')) % next_arg())
+        elif conv == 'p':
+            out.append((spec + 's') % ('0x%08x' % next_arg()))
+        elif conv == 'c':
+            out.append((spec + 'c') % chr(next_arg() & 0xFF))
+        elif conv == 's':
+            addr = next_arg()
+            s = '(null)' if addr == 0 else elf.string_at(addr)
+            out.append((spec + 's') % (s if s is not None else '<0x%08x>' % addr))
+        elif conv == '%':
+            out.append('%')
+        else:
+            out.append(spec + conv)
+    return ''.join(out)
+
+
+def get_varint(frame, i):
+    v = shift = 0
+    while True:
+        if i >= len(frame):
+            raise ValueError("truncated varint")
+        b = frame[i]
+        i += 1
+        v |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return v & 0xFFFFFFFF, i
+
+
+class Decoder(object):
+
+    def __init__(self, elf):
+        self.elf = elf
+        _, _, _, self.fmt_section = elf.sections.get('.nxlog.fmt',
+                                                     (0, 0, 0, b''))
+        self.sites = {}
+        self.time = 0
+        self.frame = bytearray()
+        self.errors = 0
+
+    def site(self, id_):
+        if id_ not in self.sites:
+            self.sites[id_] = Site(self.fmt_section, id_, self.elf)
+        return self.sites[id_]
+
+    def feed(self, data):
+        """Decode the complete frames of data, and return their lines."""
+        lines = []
+        for b in data:
+            if b:
+                self.frame.append(b)
+            elif self.frame:
+                try:
+                    lines.append(self.decode(cobs_decode(bytes(self.frame))))
+                except (ValueError, IndexError, struct.error):
+                    self.errors += 1
+                self.frame.clear()
+        return lines
+
+    def decode(self, frame):
+        id_, = struct.unpack_from('<H', frame, 0)
+        if id_ == ID_DROPPED:
+            count, i = get_varint(frame, 2)
+            return "[log] %d records dropped" % count
+
+        delta, i = get_varint(frame, 2)
+        self.time += delta
+        stamp = "[%6d.%03d]" % (self.time // 1000, self.time % 1000)
+        if id_ == ID_TEXT:
+            return "%s %s %s" % (stamp, LEVELS[frame[i]],
+                                 frame[i + 1:].decode('latin-1'))
+
+        site = self.site(id_)
+        args = []
+        for _ in range(site.nargs):
+            v, i = get_varint(frame, i)
+            args.append(v)
+        if i != len(frame):
+            raise ValueError("extra bytes")
+        return "%s %s %s:%d: %s" % (stamp, LEVELS[site.level], site.file,
+                                    site.line,
+                                    format_message(site.format, args, self.elf))
+
+
+def open_source(args):
+    if args.tcp:
+        host, port = args.tcp.rsplit(':', 1)
+        sock = socket.create_connection((host, int(port)))
+        return lambda: sock.recv(4096)
+    if args.path:
+        f = open(args.path, 'rb', buffering=0)
+    else:
+        f = sys.stdin.buffer
+    return lambda: f.read1(4096) if hasattr(f, 'read1') else f.read(4096)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Decode the binary NxOS kernel log.")
+    parser.add_argument('elf', help="ELF file of the running image")
+    parser.add_argument('path', nargs='?',
+                        help="UART device, FIFO or capture file (default: stdin)")
+    parser.add_argument('--tcp', metavar='HOST:PORT',
+                        help="read the UART from a TCP connection")
+    args = parser.parse_args()
+
+    decoder = Decoder(Elf(args.elf))
+    if not decoder.fmt_section:
+        sys.stderr.write("nxlog: %s has no .nxlog.fmt section\n" % args.elf)
+    read = open_source(args)
+
+    try:
+        while True:
+            data = read()
+            if not data:
+                break
+            for line in decoder.feed(data):
+                print(line, flush=True)
+    except KeyboardInterrupt:
+        pass
+
+    if decoder.errors:
+        sys.stderr.write("nxlog: %d bad frames\n" % decoder.errors)
+
+
+if __name__ == '__main__':
+    main()
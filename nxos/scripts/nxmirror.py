@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+#
+# Show the text display of a DE1-SoC board on the host, from the
+# frames sent over the JTAG UART by the display mirror (base/lib/mirror).
+#
+# Usage: nxmirror.py [--tcp host:port | path] [--dump]
+#
+# Without a source, the UART output is read from stdin. Console output
+# that is not part of a frame goes to stderr.
+#
+
+import argparse
+import socket
+import sys
+
+SYNC = 0x01
+ROW = ord('R')
+HEADER_SIZE = 6
+
+WIDTH = 80
+HEIGHT = 60
+
+
+def decode_rle(payload):
+    cells = bytearray()
+    i = 0
+    while i < len(payload):
+        c = payload[i]
+        i += 1
+        if c & 0x80:
+            if i >= len(payload):
+                raise ValueError("truncated run")
+            cells += bytes([payload[i]]) * ((c & 0x7F) + 1)
+            i += 1
+        else:
+            n = c + 1
+            if i + n > len(payload):
+                raise ValueError("truncated literal")
+            cells += payload[i:i + n]
+            i += n
+    return bytes(cells)
+
+
+class Mirror(object):
+    def __init__(self, dump=False):
+        self.screen = [bytes(WIDTH)] * HEIGHT
+        self.buf = bytearray()
+        self.seq = None
+        self.frames = 0
+        self.lost = 0
+        self.errors = 0
+        self.dump = dump
+
+    def feed(self, data):
+        self.buf += data
+        changed = False
+        while self.buf:
+            start = self.buf.find(bytes([SYNC]))
+            if start < 0:
+                self.console(self.buf)
+                del self.buf[:]
+                break
+            if start > 0:
+                self.console(self.buf[:start])
+                del self.buf[:start]
+            if len(self.buf) < 2:
+                break
+            if self.buf[1] != ROW:
+                self.console(self.buf[:1])
+                del self.buf[:1]
+                continue
+            if len(self.buf) < HEADER_SIZE:
+                break
+            size = HEADER_SIZE + self.buf[5] + 1
+            if len(self.buf) < size:
+                break
+            frame = bytes(self.buf[:size])
+            if self.frame(frame):
+                del self.buf[:size]
+                changed = True
+            else:
+                # Not a valid frame: resynchronize on the next byte.
+                self.errors += 1
+                self.console(self.buf[:1])
+                del self.buf[:1]
+        return changed
+
+    def frame(self, frame):
+        check = 0
+        for b in frame[2:-1]:
+            check ^= b
+        if check != frame[-1]:
+            return False
+        seq = frame[2] | (frame[3] << 8)
+        row = frame[4]
+        try:
+            cells = decode_rle(frame[HEADER_SIZE:-1])
+        except ValueError:
+            return False
+        if row >= HEIGHT:
+            return False
+
+        if self.seq is not None:
+            gap = (seq - self.seq - 1) & 0xFFFF
+            if gap:
+                self.lost += gap
+                sys.stderr.write("nxmirror: %d frame(s) lost before #%d\n"
+                                 % (gap, seq))
+        self.seq = seq
+        self.frames += 1
+        self.screen[row] = cells[:WIDTH].ljust(WIDTH, b'\0')
+        return True
+
+    def console(self, data):
+        sys.stderr.write(bytes(data).decode('latin-1'))
+        sys.stderr.flush()
+
+    def text(self):
+        return [row.replace(b'\0', b' ').decode('latin-1').rstrip()
+                for row in self.screen]
+
+    def draw(self):
+        out = ["\x1b[H"]
+        for line in self.text():
+            out.append(line + "\x1b[K\n")
+        out.append("\x1b[7m frames %d  lost %d  errors %d \x1b[0m\x1b[K"
+                   % (self.frames, self.lost, self.errors))
+        sys.stdout.write("".join(out))
+        sys.stdout.flush()
+
+
+def open_source(args):
+    if args.tcp:
+        host, port = args.tcp.rsplit(':', 1)
+        sock = socket.create_connection((host, int(port)))
+        return lambda: sock.recv(4096)
+    if args.path:
+        f = open(args.path, 'rb', buffering=0)
+    else:
+        f = sys.stdin.buffer
+    return lambda: f.read1(4096) if hasattr(f, 'read1') else f.read(4096)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Show the NxOS display mirrored over the UART.")
+    parser.add_argument('path', nargs='?',
+                        help="UART device, FIFO or capture file (default: stdin)")
+    parser.add_argument('--tcp', metavar='HOST:PORT',
+                        help="read the UART from a TCP connection")
+    parser.add_argument('--dump', action='store_true',
+                        help="print the final screen as text at end of input")
+    args = parser.parse_args()
+
+    read = open_source(args)
+    mirror = Mirror(args.dump)
+    if not args.dump:
+        sys.stdout.write("\x1b[2J")
+
+    try:
+        while True:
+            data = read()
+            if not data:
+                break
+            if mirror.feed(data) and not args.dump:
+                mirror.draw()
+    except KeyboardInterrupt:
+        pass
+
+    if args.dump:
+        for line in mirror.text():
+            print(line)
+        sys.stderr.write("nxmirror: %d frames, %d lost, %d errors\n"
+                         % (mirror.frames, mirror.lost, mirror.errors))
+
+
+if __name__ == '__main__':
+    main()
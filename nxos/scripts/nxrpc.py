@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+#
+# Host side of the NxOS remote procedure calls (base/lib/rpc), over the
+# packet link of nxlink.py.
+#
+# Usage:
+#   nxrpc.py [--tcp host:port | --device path] list
+#   nxrpc.py [...] call FUNC [ARG]... [--runs N]
+#   nxrpc.py [...] sweep FUNC [ARGS]... [--runs N]
+#
+# FUNC is a function name or id. Numbers may be given in hex with a 0x
+# prefix. sweep calls the function with each combination of its
+# arguments, each given as a number, a comma separated list, or a
+# range START:STOP[:STEP] (STOP excluded), and prints a CSV table of
+# the arguments, return values and cycle counts.
+#
+# The module can also be imported, to drive the calls from a script:
+#
+#   link = nxlink.open_link(args); link.sync()
+#   rpc = nxrpc.Rpc(link)
+#   result = rpc.call('memcpy', 4096, runs=10)
+#
+
+import argparse
+import itertools
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import nxlink  # noqa: E402
+
+RPC_PORT = 2
+MAX_ARGS = 8
+MAX_RUNS = 0xFFFF
+
+CALL, LIST = ord('C'), ord('L')
+
+STATUS = {
+    0: "ok",
+    1: "bad request",
+    2: "not found",
+    3: "wrong number of arguments",
+}
+
+
+class RpcError(Exception):
+    pass
+
+
+class Result(object):
+    """The outcome of a call: return value and cycle counts."""
+
+    def __init__(self, ret, min_, max_, total, runs):
+        self.ret, self.min, self.max, self.total = ret, min_, max_, total
+        self.runs = runs
+
+    @property
+    def avg(self):
+        return self.total / self.runs
+
+
+class Rpc(object):
+
+    def __init__(self, link):
+        self.link = link
+        self.tag = 0
+        self._functions = None
+
+    def request(self, op, id_, runs=1, args=()):
+        if len(args) > MAX_ARGS:
+            raise RpcError("too many arguments")
+        self.tag = (self.tag + 1) & 0xFFFF
+        self.link.send(RPC_PORT, struct.pack(
+            '<BBHHH%dI' % len(args), op, len(args), self.tag, id_, runs,
+            *[a & 0xFFFFFFFF for a in args]))
+
+        while True:
+            port, data = self.link.recv(timeout=30.0)
+            if port != RPC_PORT or len(data) < 4:
+                continue
+            rop, status, tag = struct.unpack_from('<BBH', data)
+            if rop == op | 0x80 and tag == self.tag:
+                return status, data[4:]
+
+    def functions(self):
+        """The functions of the target, by name: (id, number of args)."""
+        if self._functions is None:
+            self._functions = {}
+            index = 0
+            while True:
+                status, data = self.request(LIST, index)
+                if status != 0:
+                    break
+                id_, nargs = struct.unpack_from('<HB', data)
+                self._functions[data[3:].decode('latin-1')] = (id_, nargs)
+                index += 1
+        return self._functions
+
+    def resolve(self, func):
+        if isinstance(func, int):
+            return func
+        try:
+            return int(func, 0)
+        except ValueError:
+            pass
+        try:
+            return self.functions()[func][0]
+        except KeyError:
+            raise RpcError("no function %s on the target" % func)
+
+    def call(self, func, *args, runs=1):
+        if not 1 <= runs <= MAX_RUNS:
+            raise RpcError("runs must be between 1 and %d" % MAX_RUNS)
+        status, data = self.request(CALL, self.resolve(func), runs, args)
+        if status != 0:
+            raise RpcError("%s: %s" % (func, STATUS.get(status, status)))
+        ret, min_, max_, lo, hi = struct.unpack_from('<5I', data)
+        return Result(ret, min_, max_, lo | hi << 32, runs)
+
+
+def number(s):
+    return int(s, 0)
+
+
+def arg_values(spec):
+    """The values of a sweep argument: N, A,B,C or START:STOP[:STEP]."""
+    if ':' in spec:
+        parts = [number(p) for p in spec.split(':')]
+        if len(parts) not in (2, 3):
+            raise ValueError("bad range %s" % spec)
+        return list(range(*parts))
+    return [number(p) for p in spec.split(',')]
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Call functions of an NxOS target.")
+    parser.add_argument('--tcp', metavar='HOST:PORT',
+                        help="reach the UART through a TCP connection")
+    parser.add_argument('--device', metavar='PATH',
+                        help="reach the UART through a device or pty")
+    sub = parser.add_subparsers(dest='command', required=True)
+    sub.add_parser('list', help="list the target functions")
+    for name, help_ in (('call', "call a function"),
+                        ('sweep', "call a function over argument ranges")):
+        p = sub.add_parser(name, help=help_)
+        p.add_argument('func')
+        p.add_argument('args', nargs='*')
+        p.add_argument('--runs', type=number, default=1,
+                       help="runs per call, timed separately")
+    args = parser.parse_args()
+
+    link = nxlink.open_link(args)
+    try:
+        link.sync()
+        rpc = Rpc(link)
+
+        if args.command == 'list':
+            for name, (id_, nargs) in sorted(rpc.functions().items(),
+                                             key=lambda f: f[1]):
+                print("%5d  %-20s %d args" % (id_, name, nargs))
+
+        elif args.command == 'call':
+            r = rpc.call(args.func, *[number(a) for a in args.args],
+                         runs=args.runs)
+            print("return %d (0x%08x)" % (r.ret, r.ret))
+            print("cycles min %d  avg %.1f  max %d  over %d runs"
+                  % (r.min, r.avg, r.max, r.runs))
+
+        else:
+            try:
+                values = [arg_values(a) for a in args.args]
+            except ValueError as e:
+                raise RpcError(str(e))
+            names = ["arg%d" % i for i in range(len(values))]
+            print(",".join(names + ["ret", "min", "avg", "max"]))
+            for combo in itertools.product(*values):
+                r = rpc.call(args.func, *combo, runs=args.runs)
+                print(",".join([str(v) for v in combo] +
+                               [str(r.ret), str(r.min), "%.1f" % r.avg,
+                                str(r.max)]), flush=True)
+
+    except (nxlink.LinkError, RpcError) as e:
+        sys.stderr.write("nxrpc: %s\n" % e)
+        sys.exit(1)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
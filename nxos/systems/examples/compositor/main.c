@@ -0,0 +1,155 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+/* Compositor benchmark.
+ *
+ * Animates a few sprites bouncing over a striped background on the
+ * pixel framebuffer, first redrawing whole frames, then only the
+ * regions that changed. For each mode, the text display shows the
+ * average number of cycles and of pixels redrawn per frame. The time
+ * spent waiting for the vertical sync is not counted.
+ *
+ * DE1-SoC only.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/assert.h"
+#include "base/display.h"
+#include "base/drivers/systick.h"
+#include "base/drivers/fb.h"
+#include "base/lib/gfx/gfx.h"
+
+#define N_SPRITES 6
+#define SPRITE_SIZE 16
+#define FRAMES 60
+#define WARMUP_FRAMES 2
+
+/* Transparent color of the sprite images. */
+#define KEY NX_FB_RGB(255, 0, 255)
+
+static U16 ball_pixels[SPRITE_SIZE * SPRITE_SIZE] __attribute__((aligned(4)));
+static nx_gfx_surface_t ball;
+
+static struct {
+  nx_gfx_sprite_t sprite;
+  S32 x, y, dx, dy;
+} balls[N_SPRITES];
+
+static nx_gfx_comp_t comp;
+static nx_gfx_surface_t back;
+
+static void draw_background(nx_gfx_surface_t *s, void *arg) {
+  nx_gfx_rect_t band = { 0, 0, NX_FB_WIDTH, 8 };
+  S32 i;
+
+  (void)arg;
+
+  for (i = 0; i < NX_FB_HEIGHT / 8; i++) {
+    band.y = i * 8;
+    nx_gfx_fill_rect(s, &band, NX_FB_RGB(0, i * 8, 128 - i * 4));
+  }
+  for (i = 0; i < NX_FB_WIDTH; i += 40)
+    nx_gfx_vspan(s, i, 0, NX_FB_HEIGHT, NX_FB_RGB(96, 96, 96));
+}
+
+static void setup_scene(void) {
+  S32 i;
+
+  nx_gfx_surface_init(&ball, ball_pixels, SPRITE_SIZE, SPRITE_SIZE, SPRITE_SIZE);
+  nx_gfx_clear(&ball, KEY);
+  nx_gfx_fill_circle(&ball, SPRITE_SIZE / 2, SPRITE_SIZE / 2, SPRITE_SIZE / 2 - 1,
+                     NX_FB_RGB(255, 200, 0));
+  nx_gfx_circle(&ball, SPRITE_SIZE / 2, SPRITE_SIZE / 2, SPRITE_SIZE / 2 - 1,
+                NX_FB_RGB(255, 255, 255));
+
+  nx_gfx_comp_init(&comp, NX_FB_WIDTH, NX_FB_HEIGHT, draw_background, NULL);
+
+  for (i = 0; i < N_SPRITES; i++) {
+    balls[i].x = 20 + i * 45;
+    balls[i].y = 30 + i * 25;
+    balls[i].dx = (i & 1) ? 3 : -2;
+    balls[i].dy = (i & 2) ? 2 : -3;
+    nx_gfx_sprite_init(&balls[i].sprite, &ball, balls[i].x, balls[i].y);
+    nx_gfx_sprite_set_key(&balls[i].sprite, KEY);
+    nx_gfx_sprite_show(&balls[i].sprite, TRUE);
+    nx_gfx_comp_add_sprite(&comp, &balls[i].sprite);
+  }
+}
+
+static void animate(void) {
+  S32 i;
+
+  for (i = 0; i < N_SPRITES; i++) {
+    balls[i].x += balls[i].dx;
+    balls[i].y += balls[i].dy;
+    if (balls[i].x < 0 || balls[i].x > NX_FB_WIDTH - SPRITE_SIZE)
+      balls[i].dx = -balls[i].dx;
+    if (balls[i].y < 0 || balls[i].y > NX_FB_HEIGHT - SPRITE_SIZE)
+      balls[i].dy = -balls[i].dy;
+    nx_gfx_sprite_move(&balls[i].sprite, balls[i].x, balls[i].y);
+  }
+}
+
+/* Render one frame and return the cycles it took. */
+static U32 frame(bool full, U32 *pixels) {
+  U32 start, end;
+
+  animate();
+
+  start = nx_systick_get_cycles();
+  if (full)
+    nx_gfx_comp_invalidate_all(&comp);
+  *pixels = nx_gfx_comp_render(&comp, &back);
+  end = nx_systick_get_cycles();
+
+  nx_fb_swap();
+  nx_gfx_surface_back_buffer(&back);
+
+  return end - start;
+}
+
+static void bench(bool full) {
+  U32 cycles = 0, pixels = 0, p, i;
+
+  /* Bring both buffers up to date with the mode. */
+  for (i = 0; i < WARMUP_FRAMES; i++)
+    frame(full, &p);
+
+  for (i = 0; i < FRAMES; i++) {
+    cycles += frame(full, &p);
+    pixels += p;
+  }
+
+  nx_display_string(full ? "full  " : "dirty ");
+  nx_display_uint(cycles / FRAMES);
+  nx_display_string("  ");
+  nx_display_uint(pixels / FRAMES);
+  nx_display_end_line();
+}
+
+void main() {
+/* Needed to support CPUlator system init
+ * since it starts execution from main() and does not go through the system reset handler
+ */
+#include "cpulator_stub.inc"
+
+  nx_display_clear();
+  nx_display_string("mode  cycles/frame  pixels/frame");
+  nx_display_end_line();
+
+  nx_fb_init();
+  nx_gfx_surface_back_buffer(&back);
+  setup_scene();
+
+  bench(TRUE);
+  bench(FALSE);
+
+  nx_display_string("done");
+  nx_display_end_line();
+}
@@ -0,0 +1,139 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+/* Memory server over the packet link.
+ *
+ * Serves the memory requests of scripts/nxlink.py, to upload and
+ * download memory regions, e.g. test vectors and captured buffers.
+ * The text display shows the link statistics.
+ *
+ * Requests and replies go on port LINKMEM_PORT, and start with:
+ *
+ * - The operation: 'R' to read, 'W' to write, 'C' to compute the
+ *   CRC-32 of a region. Replies have bit 7 set.
+ * - The address, 4 bytes little endian.
+ * - The length, 4 bytes little endian.
+ *
+ * Replies then carry a status byte, 0 on success, then the data read,
+ * or the CRC-32 (4 bytes little endian). Writes carry the data after
+ * the header.
+ *
+ * DE1-SoC only.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/display.h"
+#include "base/drivers/systick.h"
+#include "base/lib/link/link.h"
+
+#define LINKMEM_PORT 1
+
+#define REQ_HEADER 9
+#define REPLY_HEADER (REQ_HEADER + 1)
+
+#define STATUS_OK 0
+#define STATUS_BAD_REQUEST 1
+
+#define STATS_INTERVAL_MS 500
+
+static U8 request[NX_LINK_MTU];
+static U8 reply[NX_LINK_MTU];
+
+static U32 get_u32(const U8 *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((U32)p[3] << 24);
+}
+
+static void put_u32(U8 *p, U32 v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+static void serve(U32 len) {
+  U32 addr, size, reply_len = REPLY_HEADER;
+  U8 status = STATUS_OK;
+
+  if (len < REQ_HEADER)
+    return;
+
+  addr = get_u32(&request[1]);
+  size = get_u32(&request[5]);
+
+  switch (request[0]) {
+    case 'R':
+      if (size > NX_LINK_MTU - REPLY_HEADER) {
+        status = STATUS_BAD_REQUEST;
+        break;
+      }
+      memcpy(&reply[REPLY_HEADER], (const void *)addr, size);
+      reply_len += size;
+      break;
+    case 'W':
+      if (size != len - REQ_HEADER) {
+        status = STATUS_BAD_REQUEST;
+        break;
+      }
+      memcpy((void *)addr, &request[REQ_HEADER], size);
+      break;
+    case 'C':
+      put_u32(&reply[REPLY_HEADER], nx_link_crc32((const void *)addr, size));
+      reply_len += 4;
+      break;
+    default:
+      status = STATUS_BAD_REQUEST;
+      break;
+  }
+
+  memcpy(reply, request, REQ_HEADER);
+  reply[0] |= 0x80;
+  reply[REQ_HEADER] = status;
+  nx_link_send(LINKMEM_PORT, reply, reply_len, TRUE);
+}
+
+static void show_stats(void) {
+  nx_link_stats_t stats;
+
+  nx_link_get_stats(&stats);
+  nx_display_cursor_set_pos(0, 2);
+  nx_display_printf("rx %8lu  tx %8lu  retransmits %6lu\n",
+                    stats.rx_packets, stats.tx_packets, stats.retransmits);
+  nx_display_printf("crc errors %6lu  frame errors %6lu  dropped %6lu\n",
+                    stats.crc_errors, stats.frame_errors, stats.rx_dropped);
+}
+
+void main() {
+/* Needed to support CPUlator system init
+ * since it starts execution from main() and does not go through the system reset handler
+ */
+#include "cpulator_stub.inc"
+
+  U32 last = 0;
+  S32 len;
+  U8 port;
+
+  nx_display_clear();
+  nx_display_string("linkmem: waiting for nxlink.py\n");
+
+  nx_link_init(NX_UART_0);
+
+  while (TRUE) {
+    nx_link_poll();
+
+    while ((len = nx_link_recv(&port, request, sizeof(request))) >= 0) {
+      if (port == LINKMEM_PORT)
+        serve(len);
+    }
+
+    if (nx_systick_get_ms() - last >= STATS_INTERVAL_MS) {
+      last = nx_systick_get_ms();
+      show_stats();
+    }
+  }
+}
@@ -0,0 +1,79 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+/* Kernel log cost benchmark.
+ *
+ * Logs the same message with nx_log(), and with NX_LOG(), which is
+ * binary when built with LOGBIN=1. For each, the text display shows
+ * the system timer cycles spent per message by the caller, and the
+ * UART bytes per message written by the flush.
+ *
+ * In binary mode, decode the UART output with:
+ *   scripts/nxlog.py logbench.elf
+ *
+ * DE1-SoC only.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/display.h"
+#include "base/drivers/systick.h"
+#include "base/drivers/uart.h"
+#include "base/lib/log/log.h"
+
+/* Fits in the ring, so that nothing is dropped. */
+#define MESSAGES (NX_LOG_RECORDS / 2)
+
+typedef enum {
+  MODE_TEXT = 0,
+  MODE_MACRO,
+} bench_mode_t;
+
+static const char *mode_names[] = { "nx_log", "NX_LOG" };
+
+static void log_message(bench_mode_t mode, U32 i) {
+  if (mode == MODE_TEXT)
+    nx_log(NX_LOG_INFO, "sample %lu: speed %lu, error %ld", i, i * 3, -(S32)i);
+  else
+    NX_LOG(NX_LOG_INFO, "sample %lu: speed %lu, error %ld", i, i * 3, -(S32)i);
+}
+
+static void bench(bench_mode_t mode) {
+  nx_uart_stats_t stats;
+  U32 start, cycles, i;
+
+  start = nx_systick_get_cycles();
+  for (i = 0; i < MESSAGES; i++)
+    log_message(mode, i);
+  cycles = nx_systick_get_cycles() - start;
+
+  nx_uart_reset_stats();
+  while (nx_log_get_pending() > 0)
+    nx_log_flush();
+  nx_uart_get_stats(&stats);
+
+  nx_display_printf("%s %8lu %6lu\n", mode_names[mode],
+                    cycles / MESSAGES, stats.tx_bytes / MESSAGES);
+}
+
+void main() {
+/* Needed to support CPUlator system init
+ * since it starts execution from main() and does not go through the system reset handler
+ */
+#include "cpulator_stub.inc"
+
+  nx_display_clear();
+  nx_display_string("mode    cycles/msg  bytes/msg\n");
+
+  nx_log_init();
+
+  bench(MODE_TEXT);
+  bench(MODE_MACRO);
+
+  nx_display_string("done\n");
+}
@@ -0,0 +1,255 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+/* Memory and string operations benchmark.
+ *
+ * Runs a size sweep of memcpy (aligned and misaligned source),
+ * memmove (overlapping, backward), memset, strlen, streq and strchr,
+ * and compares the cycle counts of the NxOS implementations against
+ * the byte-at-a-time reference versions below. The results of each
+ * run are also checked against the reference.
+ *
+ * Each line shows: operation, size, reference cycles, NxOS cycles.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/assert.h"
+#include "base/display.h"
+#include "base/drivers/systick.h"
+
+#define MAX_SIZE 4096
+#define REPEATS 4
+
+/* Keep the compiler from turning the reference loops into library
+ * calls, or from inlining them.
+ */
+#define REF_FN __attribute__((noinline, optimize("no-tree-loop-distribute-patterns")))
+
+static const U32 sizes[] = { 4, 16, 64, 256, 1024, MAX_SIZE };
+#define NUM_SIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+static U8 src[MAX_SIZE + 64] __attribute__((aligned(4)));
+static U8 dst[MAX_SIZE + 64] __attribute__((aligned(4)));
+static U8 ref[MAX_SIZE + 64] __attribute__((aligned(4)));
+
+typedef enum {
+  OP_MEMCPY = 0,
+  OP_MEMCPY_MISALIGNED,
+  OP_MEMMOVE,
+  OP_MEMSET,
+  OP_STRLEN,
+  OP_STREQ,
+  OP_STRCHR,
+  OP_COUNT
+} op_t;
+
+static const char *op_names[OP_COUNT] = {
+  "memcpy  ",
+  "memcpy+1",
+  "memmove ",
+  "memset  ",
+  "strlen  ",
+  "streq   ",
+  "strchr  ",
+};
+
+/* Reference byte-at-a-time implementations. */
+
+static REF_FN void ref_memcpy(U8 *d, const U8 *s, U32 n) {
+  while (n--)
+    *d++ = *s++;
+}
+
+static REF_FN void ref_memmove_back(U8 *d, const U8 *s, U32 n) {
+  d += n;
+  s += n;
+  while (n--)
+    *--d = *--s;
+}
+
+static REF_FN void ref_memset(U8 *d, U8 val, U32 n) {
+  while (n--)
+    *d++ = val;
+}
+
+static REF_FN U32 ref_strlen(const char *str) {
+  U32 i = 0;
+
+  while (*str++)
+    i++;
+
+  return i;
+}
+
+static REF_FN bool ref_streq(const char *a, const char *b) {
+  while (*a != '\0' && *b != '\0') {
+    if (*a++ != *b++)
+      return FALSE;
+  }
+
+  return *a == *b ? TRUE : FALSE;
+}
+
+static REF_FN char *ref_strchr(const char *s, const char c) {
+  while (*s) {
+    if (*s == c)
+      return (char*)s;
+    s++;
+  }
+
+  return NULL;
+}
+
+static void fill_buffers(U32 size) {
+  U32 i;
+
+  for (i = 0; i < sizeof(src); i++) {
+    src[i] = (U8)(i * 7 + 1);
+    dst[i] = 0;
+    ref[i] = 0;
+  }
+
+  /* Strings: 'a'..'z' without NUL for size bytes, terminated, the
+   * searched character only at the very end.
+   */
+  for (i = 0; i < size; i++) {
+    dst[i] = ref[i] = 'a' + (i % 25);
+  }
+  dst[size] = ref[size] = '\0';
+  if (size > 0)
+    dst[size - 1] = ref[size - 1] = 'z';
+}
+
+static bool buffers_equal(U32 len) {
+  U32 i;
+
+  for (i = 0; i < len; i++)
+    if (dst[i] != ref[i])
+      return FALSE;
+
+  return TRUE;
+}
+
+/* Run one operation, either with the reference or the NxOS version, and
+ * return the elapsed cycles.
+ */
+static U32 run_op(op_t op, U32 size, bool reference) {
+  volatile U32 result = 0;
+  U8 *out = reference ? ref : dst;
+  U32 start, end;
+
+  start = nx_systick_get_cycles();
+
+  switch (op) {
+  case OP_MEMCPY:
+    if (reference)
+      ref_memcpy(out, src, size);
+    else
+      memcpy(out, src, size);
+    break;
+  case OP_MEMCPY_MISALIGNED:
+    if (reference)
+      ref_memcpy(out, src + 1, size);
+    else
+      memcpy(out, src + 1, size);
+    break;
+  case OP_MEMMOVE:
+    if (reference)
+      ref_memmove_back(out + 8, out, size);
+    else
+      memmove(out + 8, out, size);
+    break;
+  case OP_MEMSET:
+    if (reference)
+      ref_memset(out + 1, 0x5A, size);
+    else
+      memset(out + 1, 0x5A, size);
+    break;
+  case OP_STRLEN:
+    result = reference ? ref_strlen((char*)out) : strlen((char*)out);
+    break;
+  case OP_STREQ:
+    result = reference ? ref_streq((char*)dst, (char*)ref) :
+      streq((char*)dst, (char*)ref);
+    break;
+  case OP_STRCHR:
+    result = (U32)(reference ? ref_strchr((char*)out, 'z') :
+                   strchr((char*)out, 'z'));
+    result -= (U32)out;
+    break;
+  default:
+    break;
+  }
+
+  end = nx_systick_get_cycles();
+
+  /* String results must match the reference ones. */
+  switch (op) {
+  case OP_STRLEN:
+    NX_ASSERT(result == size);
+    break;
+  case OP_STREQ:
+    NX_ASSERT(result == TRUE);
+    break;
+  case OP_STRCHR:
+    NX_ASSERT(result == size - 1);
+    break;
+  default:
+    break;
+  }
+
+  return end - start;
+}
+
+static void bench(op_t op, U32 size) {
+  U32 ref_cycles = 0xFFFFFFFF, new_cycles = 0xFFFFFFFF;
+  U32 i, t;
+
+  for (i = 0; i < REPEATS; i++) {
+    fill_buffers(size);
+    t = run_op(op, size, TRUE);
+    ref_cycles = MIN(ref_cycles, t);
+    t = run_op(op, size, FALSE);
+    new_cycles = MIN(new_cycles, t);
+
+    NX_ASSERT_MSG(buffers_equal(sizeof(dst)), op_names[op]);
+  }
+
+  nx_display_string(op_names[op]);
+  nx_display_string(" ");
+  nx_display_uint(size);
+  nx_display_string("  ");
+  nx_display_uint(ref_cycles);
+  nx_display_string("  ");
+  nx_display_uint(new_cycles);
+  nx_display_end_line();
+}
+
+void main() {
+/* Needed to support CPUlator system init
+ * since it starts execution from main() and does not go through the system reset handler
+ */
+#include "cpulator_stub.inc"
+
+  op_t op;
+  U32 i;
+
+  nx_display_clear();
+  nx_display_scroll_ok(TRUE);
+  nx_display_string("op       size  ref cycles  nxos cycles");
+  nx_display_end_line();
+
+  for (op = 0; op < OP_COUNT; op++) {
+    for (i = 0; i < NUM_SIZES; i++)
+      bench(op, sizes[i]);
+  }
+
+  nx_display_string("done");
+  nx_display_end_line();
+}
@@ -0,0 +1,95 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+/* Console and telemetry sharing the packet link.
+ *
+ * The console channel reports the uptime every second, while the
+ * telemetry channel is fed a record every millisecond, more than the
+ * JTAG UART carries: telemetry records get dropped, the console lines
+ * do not, nor wait for the telemetry. The text display shows the
+ * channel counters.
+ *
+ * Watch it with: scripts/nxlink.py monitor
+ *
+ * DE1-SoC only.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/display.h"
+#include "base/drivers/systick.h"
+#include "base/lib/link/link.h"
+#include "base/lib/mux/mux.h"
+
+#define TELEMETRY_INTERVAL_MS 1
+#define CONSOLE_INTERVAL_MS 1000
+#define STATS_INTERVAL_MS 500
+
+static U8 console_buf[512];
+static U8 telemetry_buf[256];
+
+static nx_mux_channel_t console;
+static nx_mux_channel_t telemetry;
+
+/* A telemetry record: the time and a few fake measurements. */
+static void send_telemetry(U32 now) {
+  U32 record[4] = { now, now * 3, now ^ 0x5A5A5A5A, ~now };
+
+  nx_mux_write(&telemetry, record, sizeof(record));
+}
+
+static void show_stats(void) {
+  nx_display_cursor_set_pos(0, 2);
+  nx_display_printf("console   sent %8lu  dropped %6lu\n",
+                    nx_mux_get_sent(&console), nx_mux_get_dropped(&console));
+  nx_display_printf("telemetry sent %8lu  dropped %6lu\n",
+                    nx_mux_get_sent(&telemetry),
+                    nx_mux_get_dropped(&telemetry));
+}
+
+void main() {
+/* Needed to support CPUlator system init
+ * since it starts execution from main() and does not go through the system reset handler
+ */
+#include "cpulator_stub.inc"
+
+  U32 now, last_telemetry = 0, last_console = 0, last_stats = 0;
+
+  nx_display_clear();
+  nx_display_string("muxdemo: console and telemetry\n");
+
+  nx_link_init(NX_UART_0);
+  nx_mux_init();
+  nx_mux_add(&console, NX_MUX_PORT_CONSOLE, 0, NX_MUX_RELIABLE,
+             console_buf, sizeof(console_buf));
+  nx_mux_add(&telemetry, NX_MUX_PORT_TELEMETRY, 1,
+             NX_MUX_DROP | NX_MUX_DATAGRAM,
+             telemetry_buf, sizeof(telemetry_buf));
+
+  while (TRUE) {
+    now = nx_systick_get_ms();
+
+    if (now - last_telemetry >= TELEMETRY_INTERVAL_MS) {
+      last_telemetry = now;
+      send_telemetry(now);
+    }
+
+    if (now - last_console >= CONSOLE_INTERVAL_MS) {
+      last_console = now;
+      nx_mux_printf(&console, "uptime %lu s, telemetry dropped %lu\n",
+                    now / 1000, nx_mux_get_dropped(&telemetry));
+    }
+
+    if (now - last_stats >= STATS_INTERVAL_MS) {
+      last_stats = now;
+      show_stats();
+    }
+
+    nx_mux_pump();
+  }
+}
@@ -0,0 +1,192 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+/* NEON kernels benchmark.
+ *
+ * Runs every kernel of the neon library on the same input with its
+ * scalar and its accelerated version, checks that the results are
+ * identical, and compares the cycle counts.
+ *
+ * Build with NEON=1 to get the NEON versions; otherwise both columns
+ * run the same scalar code.
+ *
+ * Each line shows: kernel, size in bytes, scalar cycles, NEON cycles.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/assert.h"
+#include "base/display.h"
+#include "base/drivers/systick.h"
+#include "base/lib/neon/neon.h"
+
+#define SIZE 4096
+#define REPEATS 4
+
+static U8 in[SIZE] __attribute__((aligned(8)));
+static U8 out_scalar[SIZE] __attribute__((aligned(8)));
+static U8 out_neon[SIZE] __attribute__((aligned(8)));
+
+typedef enum {
+  K_FILL32 = 0,
+  K_COPY,
+  K_FILL16,
+  K_BLEND565,
+  K_MIX,
+  K_GAIN,
+  K_CHECKSUM,
+  K_CRC32,
+  K_COUNT
+} kernel_t;
+
+static const char *kernel_names[K_COUNT] = {
+  "fill32  ",
+  "copy    ",
+  "fill16  ",
+  "blend565",
+  "mix     ",
+  "gain    ",
+  "cksum16 ",
+  "crc32   ",
+};
+
+static bool buffers_equal(void) {
+  U32 i;
+
+  for (i = 0; i < SIZE; i++)
+    if (out_scalar[i] != out_neon[i])
+      return FALSE;
+
+  return TRUE;
+}
+
+static void fill_buffers(void) {
+  U32 i;
+
+  for (i = 0; i < SIZE; i++) {
+    in[i] = (U8)(i * 13 + 7);
+    out_scalar[i] = out_neon[i] = (U8)(i * 5 + 3);
+  }
+}
+
+/* Run one kernel on size bytes and return the elapsed cycles. The
+ * result of the checksum kernels is stored in *result.
+ */
+static U32 run_kernel(kernel_t k, U32 size, bool neon, U32 *result) {
+  U8 *out = neon ? out_neon : out_scalar;
+  U32 start, end;
+
+  start = nx_systick_get_cycles();
+
+  switch (k) {
+  case K_FILL32:
+    if (neon)
+      nx_neon_fill32((U32*)out, 0xA5A55A5A, size / 4);
+    else
+      nx_neon_fill32_scalar((U32*)out, 0xA5A55A5A, size / 4);
+    break;
+  case K_COPY:
+    if (neon)
+      nx_neon_copy(out, in, size);
+    else
+      nx_neon_copy_scalar(out, in, size);
+    break;
+  case K_FILL16:
+    if (neon)
+      nx_neon_fill16((U16*)out, 0xF81F, size / 2);
+    else
+      nx_neon_fill16_scalar((U16*)out, 0xF81F, size / 2);
+    break;
+  case K_BLEND565:
+    if (neon)
+      nx_neon_blend565((U16*)out, (U16*)in, 96, size / 2);
+    else
+      nx_neon_blend565_scalar((U16*)out, (U16*)in, 96, size / 2);
+    break;
+  case K_MIX:
+    if (neon)
+      nx_neon_mix_s16((S16*)out, (S16*)in, size / 2);
+    else
+      nx_neon_mix_s16_scalar((S16*)out, (S16*)in, size / 2);
+    break;
+  case K_GAIN:
+    if (neon)
+      nx_neon_gain_stereo_s16((S16*)out, size / 4, 384, 128);
+    else
+      nx_neon_gain_stereo_s16_scalar((S16*)out, size / 4, 384, 128);
+    break;
+  case K_CHECKSUM:
+    *result = neon ? nx_neon_checksum16(in, size) :
+      nx_neon_checksum16_scalar(in, size);
+    break;
+  case K_CRC32:
+    *result = neon ? nx_neon_crc32(0, in, size) :
+      nx_neon_crc32_scalar(0, in, size);
+    break;
+  default:
+    break;
+  }
+
+  end = nx_systick_get_cycles();
+
+  return end - start;
+}
+
+static void bench(kernel_t k, U32 size) {
+  U32 scalar_cycles = 0xFFFFFFFF, neon_cycles = 0xFFFFFFFF;
+  U32 scalar_result = 0, neon_result = 0;
+  U32 i, t;
+
+  for (i = 0; i < REPEATS; i++) {
+    fill_buffers();
+    t = run_kernel(k, size, FALSE, &scalar_result);
+    scalar_cycles = MIN(scalar_cycles, t);
+    t = run_kernel(k, size, TRUE, &neon_result);
+    neon_cycles = MIN(neon_cycles, t);
+
+    NX_ASSERT_MSG(buffers_equal(), kernel_names[k]);
+    NX_ASSERT_MSG(scalar_result == neon_result, kernel_names[k]);
+  }
+
+  nx_display_string(kernel_names[k]);
+  nx_display_string(" ");
+  nx_display_uint(size);
+  nx_display_string("  ");
+  nx_display_uint(scalar_cycles);
+  nx_display_string("  ");
+  nx_display_uint(neon_cycles);
+  nx_display_end_line();
+}
+
+void main() {
+/* Needed to support CPUlator system init
+ * since it starts execution from main() and does not go through the system reset handler
+ */
+#include "cpulator_stub.inc"
+
+  kernel_t k;
+
+  nx_display_clear();
+  nx_display_scroll_ok(TRUE);
+  nx_display_string(nx_neon_enabled ? "NEON build" : "scalar build");
+  nx_display_end_line();
+  nx_display_string("kernel   size  scalar  neon");
+  nx_display_end_line();
+
+  /* Known answers first. */
+  NX_ASSERT(nx_neon_crc32(0, (const U8*)"123456789", 9) == 0xCBF43926);
+  NX_ASSERT(nx_neon_checksum16((const U8*)"\x01\x02\x03", 3) == 0x0204);
+
+  for (k = 0; k < K_COUNT; k++) {
+    bench(k, 256);
+    bench(k, SIZE);
+  }
+
+  nx_display_string("done");
+  nx_display_end_line();
+}
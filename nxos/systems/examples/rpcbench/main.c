@@ -0,0 +1,117 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+/* Benchmarks run from the host, over remote procedure calls.
+ *
+ * The kernels take their sizes as arguments, so that the host sweeps
+ * them without rebuilding the image, e.g.:
+ *
+ *   scripts/nxrpc.py list
+ *   scripts/nxrpc.py call memcpy 4096 --runs 10
+ *   scripts/nxrpc.py sweep stride 1,2,4,8,16 1024 --runs 5
+ *
+ * The text display shows the number of calls served and the link
+ * statistics.
+ *
+ * DE1-SoC only.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/display.h"
+#include "base/drivers/systick.h"
+#include "base/lib/link/link.h"
+#include "base/lib/rpc/rpc.h"
+
+#define BUF_SIZE 16384
+
+#define STATS_INTERVAL_MS 500
+
+static U8 src[BUF_SIZE], dst[BUF_SIZE];
+
+/* The sizes are clipped to the buffers. */
+
+static U32 run_memcpy(const U32 *args) {
+  memcpy(dst, src, MIN(args[0], BUF_SIZE));
+  return 0;
+}
+
+static U32 run_memset(const U32 *args) {
+  memset(dst, args[1], MIN(args[0], BUF_SIZE));
+  return 0;
+}
+
+static U32 run_crc32(const U32 *args) {
+  return nx_link_crc32(src, MIN(args[0], BUF_SIZE));
+}
+
+/* Read count words, stride words apart, wrapping around the buffer. */
+static U32 run_stride(const U32 *args) {
+  const volatile U32 *words = (const volatile U32 *)src;
+  U32 stride = args[0], count = args[1], i, j = 0, sum = 0;
+
+  for (i = 0; i < count; i++) {
+    sum += words[j];
+    j = (j + stride) % (BUF_SIZE / 4);
+  }
+  return sum;
+}
+
+static U32 run_loop(const U32 *args) {
+  volatile U32 i;
+
+  for (i = 0; i < args[0]; i++);
+  return i;
+}
+
+static const nx_rpc_func_t funcs[] = {
+  { 1, 1, "memcpy", run_memcpy },
+  { 2, 2, "memset", run_memset },
+  { 3, 1, "crc32", run_crc32 },
+  { 4, 2, "stride", run_stride },
+  { 5, 1, "loop", run_loop },
+};
+
+static void show_stats(void) {
+  nx_link_stats_t stats;
+
+  nx_link_get_stats(&stats);
+  nx_display_cursor_set_pos(0, 2);
+  nx_display_printf("calls %8lu\n", nx_rpc_get_calls());
+  nx_display_printf("rx %8lu  tx %8lu  retransmits %6lu\n",
+                    stats.rx_packets, stats.tx_packets, stats.retransmits);
+}
+
+void main() {
+/* Needed to support CPUlator system init
+ * since it starts execution from main() and does not go through the system reset handler
+ */
+#include "cpulator_stub.inc"
+
+  U32 i, last = 0;
+
+  nx_display_clear();
+  nx_display_string("rpcbench: waiting for nxrpc.py\n");
+
+  for (i = 0; i < BUF_SIZE; i++)
+    src[i] = i * 7;
+
+  nx_link_init(NX_UART_0);
+  nx_rpc_init();
+  for (i = 0; i < sizeof(funcs) / sizeof(funcs[0]); i++)
+    nx_rpc_register(&funcs[i]);
+
+  while (TRUE) {
+    nx_rpc_poll();
+
+    if (nx_systick_get_ms() - last >= STATS_INTERVAL_MS) {
+      last = nx_systick_get_ms();
+      show_stats();
+    }
+  }
+}
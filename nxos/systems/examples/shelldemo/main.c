@@ -0,0 +1,88 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+/* The diagnostic shell on the first JTAG UART.
+ *
+ * The application counts in the background, and holds a few
+ * allocations, so that uptime, heap, irq and stack have something to
+ * show. It adds a "count" command, and benchmarks for bench.
+ *
+ * Try: help, irq, stack, dump 0x0, bench all 100
+ *
+ * DE1-SoC only.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/format.h"
+#include "base/display.h"
+#include "base/drivers/systick.h"
+#include "base/lib/memalloc/memalloc.h"
+#include "base/lib/shell/shell.h"
+
+#define BUF_SIZE 1024
+#define ALLOCATIONS 4
+
+static U32 counter;
+
+static U8 src[BUF_SIZE], dst[BUF_SIZE];
+
+static S32 cmd_count(U32 argc, char **argv) {
+  if (argc == 2 && streq(argv[1], "reset"))
+    counter = 0;
+  else if (argc != 1)
+    return -1;
+  nx_shell_printf("counter %lu\n", counter);
+  return 0;
+}
+
+static const nx_shell_cmd_t count_cmd = {
+  "count", cmd_count, "[reset]  show or reset the counter"
+};
+
+static void bench_memcpy(void) {
+  memcpy(dst, src, BUF_SIZE);
+}
+
+static void bench_memset(void) {
+  memset(dst, 0, BUF_SIZE);
+}
+
+static void bench_snprintf(void) {
+  char buf[32];
+
+  nx_snprintf(buf, sizeof(buf), "%lu %08lx %s", counter, counter, "abc");
+}
+
+void main() {
+/* Needed to support CPUlator system init
+ * since it starts execution from main() and does not go through the system reset handler
+ */
+#include "cpulator_stub.inc"
+
+  U32 i;
+
+  nx_display_clear();
+  nx_display_string("shelldemo: shell on JTAG UART 0\n");
+
+  nx_memalloc_init();
+  for (i = 0; i < ALLOCATIONS; i++)
+    nx_malloc(BUF_SIZE << i);
+
+  nx_shell_init(NX_UART_0);
+  nx_shell_register(&count_cmd);
+  nx_shell_register_bench("memcpy1k", bench_memcpy);
+  nx_shell_register_bench("memset1k", bench_memset);
+  nx_shell_register_bench("snprintf", bench_snprintf);
+
+  /* The shell runs while waiting. */
+  while (TRUE) {
+    counter++;
+    nx_systick_wait_ms(10);
+  }
+}
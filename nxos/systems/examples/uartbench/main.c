@@ -0,0 +1,128 @@
+/* Copyright (C) 2007-2020 the NxOS developers
+ *
+ * See AUTHORS for a full list of the developers.
+ *
+ * Redistribution of this file is permitted under
+ * the terms of the GNU Public License (GPL) version 2.
+ */
+
+/* UART write throughput benchmark.
+ *
+ * Sends the same lines of text over the JTAG UART one byte at a time
+ * with nx_uart_putchar(), as whole lines with nx_uart_writebuf(), and
+ * as a header and a payload with nx_uart_writev(). For each mode, the
+ * text display shows the throughput in bytes per second, and the
+ * number of UART register accesses per 100 bytes sent.
+ *
+ * The lines are sent in rounds that fit in the transmit ring, so that
+ * the register accesses counted are those of the write path, not of
+ * waiting for room.
+ *
+ * DE1-SoC only.
+ */
+
+#include "base/types.h"
+#include "base/util.h"
+#include "base/display.h"
+#include "base/drivers/systick.h"
+#include "base/drivers/uart.h"
+
+#define ROUNDS 16
+#define LINES_PER_ROUND 15
+#define HEADER_SIZE 8
+#define LINE_SIZE 64
+
+typedef enum {
+  MODE_PUTCHAR = 0,
+  MODE_WRITEBUF,
+  MODE_WRITEV,
+} bench_mode_t;
+
+static const char *mode_names[] = { "putchar ", "writebuf", "writev  " };
+
+static U8 line[LINE_SIZE];
+static U32 ring_size;
+
+static void setup_line(void) {
+  U32 i;
+
+  for (i = 0; i < LINE_SIZE - 1; i++)
+    line[i] = 'a' + i % 26;
+  line[LINE_SIZE - 1] = '\n';
+}
+
+/* Wait for everything queued to reach the FIFO. */
+static void drain(void) {
+  while (nx_uart_write_avail() < ring_size);
+}
+
+static void send_line(bench_mode_t mode, U32 n) {
+  nx_uart_iovec_t iov[2];
+  U32 i;
+
+  /* The header is the line number, in the first bytes of the line. */
+  for (i = HEADER_SIZE - 1; i > 0; i--, n /= 10)
+    line[i - 1] = '0' + n % 10;
+  line[HEADER_SIZE - 1] = ' ';
+
+  switch (mode) {
+    case MODE_PUTCHAR:
+      for (i = 0; i < LINE_SIZE; i++)
+        nx_uart_putchar(line[i]);
+      break;
+    case MODE_WRITEBUF:
+      nx_uart_writebuf(line, LINE_SIZE);
+      break;
+    case MODE_WRITEV:
+      iov[0].buf = line;
+      iov[0].len = HEADER_SIZE;
+      iov[1].buf = &line[HEADER_SIZE];
+      iov[1].len = LINE_SIZE - HEADER_SIZE;
+      nx_uart_writev(iov, 2);
+      break;
+  }
+}
+
+static void bench(bench_mode_t mode) {
+  nx_uart_stats_t stats;
+  U32 start, ms, round, i, bytes = 0, mmio = 0;
+
+  drain();
+  start = nx_systick_get_ms();
+
+  for (round = 0; round < ROUNDS; round++) {
+    nx_uart_reset_stats();
+    for (i = 0; i < LINES_PER_ROUND; i++)
+      send_line(mode, round * LINES_PER_ROUND + i);
+    nx_uart_get_stats(&stats);
+
+    bytes += stats.tx_bytes;
+    mmio += stats.mmio_reads + stats.mmio_writes;
+    drain();
+  }
+
+  ms = nx_systick_get_ms() - start;
+
+  nx_display_printf("%s %8lu %6lu\n", mode_names[mode],
+                    bytes * 1000 / MAX(ms, 1), mmio * 100 / MAX(bytes, 1));
+}
+
+void main() {
+/* Needed to support CPUlator system init
+ * since it starts execution from main() and does not go through the system reset handler
+ */
+#include "cpulator_stub.inc"
+
+  nx_display_clear();
+  nx_display_string("mode     bytes/s  mmio/100B\n");
+
+  setup_line();
+  nx_systick_wait_ms(10);
+  ring_size = nx_uart_write_avail();
+
+  bench(MODE_PUTCHAR);
+  bench(MODE_WRITEBUF);
+  bench(MODE_WRITEV);
+
+  nx_display_string("done\n");
+}
@@ -7,6 +7,7 @@
 #include "base/core.h"
 #include "base/display.h"
 #include "base/drivers/systick.h"
+#include "base/drivers/button.h"
 #include "base/lib/gui/gui.h"
 
 void main(void) {
@@ -42,9 +43,9 @@ void main(void) {
         nx_display_end_line();
 
         nx_display_string("\nOk to go back");
-#if 0
-        while (nx_avr_get_button() != BUTTON_OK);
-#endif
+        nx_de1_button_clear_events();
+        while (nx_de1_get_button_event() != BUTTON_0)
+          nx_display_flush();
         break;
     }
   }